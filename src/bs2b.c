@@ -21,11 +21,20 @@
  * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <limits.h>
 #include <math.h>
 #include <stdlib.h>
 #include <memory.h>
+#include <string.h>
 
 #include "bs2b.h"
+#include "bs2bkernel.h"
+#include "bs2bpresets.h"
+#include "bs2bthread.h"
+
+#if defined( BS2B_HAVE_X86 ) && defined( _MSC_VER )
+#include <intrin.h>
+#endif
 
 #ifndef M_PI
 #define M_PI  3.14159265358979323846
@@ -45,6 +54,15 @@ static void int24swap( bs2b_uint24_t *x )
 	x->octet2 = x1;
 }
 
+static void sint24swap( bs2b_int24_t *x )
+{
+	uint8_t x1;
+
+	x1 = x->octet0;
+	x->octet0 = ( uint8_t )x->octet2;
+	x->octet2 = ( int8_t )x1;
+}
+
 static void int32swap( uint32_t *x )
 {
 	*x = ( *x >> 24 ) | ( ( *x >> 8 ) & 0xff00 ) |
@@ -63,7 +81,7 @@ static void int64swap( uint32_t *x )
 	int32swap( x + 1 );
 }
 
-static double int242double( bs2b_int24_t *in )
+static double int242double( bs2b_int24_t const *in )
 {
 	int32_t out =
 		#ifdef WORDS_BIGENDIAN
@@ -81,7 +99,7 @@ static double int242double( bs2b_int24_t *in )
 	return ( double )out;
 } /* int242double() */
 
-static double uint242double( bs2b_uint24_t *in )
+static double uint242double( bs2b_uint24_t const *in )
 {
 	uint32_t out =
 		#ifdef WORDS_BIGENDIAN
@@ -127,8 +145,35 @@ static void double2uint24( double in, bs2b_uint24_t *out )
 	#endif /* WORDS_BIGENDIAN */
 } /* double2uint24() */
 
+#define MAX_INT32_VALUE  2147483647.0
+#define MIN_INT32_VALUE -2147483648.0
+#define MAX_INT24_VALUE     8388607.0
+#define MIN_INT24_VALUE    -8388608.0
+#define MAX_INT16_VALUE       32767.0
+#define MIN_INT16_VALUE      -32768.0
+#define MAX_INT8_VALUE          127.0
+#define MIN_INT8_VALUE         -128.0
+
 /* Set up bs2b data. */
-static void init( t_bs2bdp bs2bdp )
+/* Rounds to Q30 fixed-point, all coefficients are within ( -1, 1 ) */
+#define Q30( x ) ( ( int32_t )floor( ( x ) * 1073741824.0 + 0.5 ) )
+
+/* Replaces out of range sample rate and crossfeed level by defaults */
+static void check_params( t_bs2bdp bs2bdp )
+{
+	uint32_t fcut = bs2bdp->level & 0xffff;
+	uint32_t feed = ( bs2bdp->level & 0xffff0000 ) >> 16;
+
+	if( ( bs2bdp->srate > BS2B_MAXSRATE ) || ( bs2bdp->srate < BS2B_MINSRATE ) )
+		bs2bdp->srate = BS2B_DEFAULT_SRATE;
+
+	if( ( fcut > BS2B_MAXFCUT ) || ( fcut < BS2B_MINFCUT ) ||
+		( feed > BS2B_MAXFEED ) || ( feed < BS2B_MINFEED ) )
+		bs2bdp->level = BS2B_DEFAULT_CLEVEL;
+} /* check_params() */
+
+/* Computes coefficients by checked sample rate and crossfeed level */
+static void init_coef( t_bs2bdp bs2bdp )
 {
 	double Fc_lo; /* Lowpass filter cut frequency (Hz) */
 	double Fc_hi; /* Highboost filter cut frequency (Hz) */
@@ -139,20 +184,9 @@ static void init( t_bs2bdp bs2bdp )
 	double level; /* Feeding level (dB) ( level = GB_lo - GB_hi ) */
 	double x;
 
-	if( ( bs2bdp->srate > BS2B_MAXSRATE ) || ( bs2bdp->srate < BS2B_MINSRATE ) )
-		bs2bdp->srate = BS2B_DEFAULT_SRATE;
-
 	Fc_lo = bs2bdp->level & 0xffff;
 	level = ( bs2bdp->level & 0xffff0000 ) >> 16;
 
-	if( ( Fc_lo > BS2B_MAXFCUT ) || ( Fc_lo < BS2B_MINFCUT ) ||
-		( level > BS2B_MAXFEED ) || ( level < BS2B_MINFEED ) )
-	{
-		bs2bdp->level = BS2B_DEFAULT_CLEVEL;
-		Fc_lo = bs2bdp->level & 0xffff;
-		level = ( bs2bdp->level & 0xffff0000 ) >> 16;
-	}
-
 	level /= 10.0;
 
 	GB_lo = level * -5.0 / 6.0 - 3.0;
@@ -177,8 +211,243 @@ static void init( t_bs2bdp bs2bdp )
 	bs2bdp->a1_hi = -x;
 
 	bs2bdp->gain  = 1.0 / ( 1.0 - G_hi + G_lo );
+
+	bs2bdp->f.a0_lo = ( float )bs2bdp->a0_lo;
+	bs2bdp->f.b1_lo = ( float )bs2bdp->b1_lo;
+	bs2bdp->f.a0_hi = ( float )bs2bdp->a0_hi;
+	bs2bdp->f.a1_hi = ( float )bs2bdp->a1_hi;
+	bs2bdp->f.b1_hi = ( float )bs2bdp->b1_hi;
+	bs2bdp->f.gain  = ( float )bs2bdp->gain;
+
+	bs2bdp->q.a0_lo = Q30( bs2bdp->a0_lo );
+	bs2bdp->q.b1_lo = Q30( bs2bdp->b1_lo );
+	bs2bdp->q.a0_hi = Q30( bs2bdp->a0_hi );
+	bs2bdp->q.a1_hi = Q30( bs2bdp->a1_hi );
+	bs2bdp->q.b1_hi = Q30( bs2bdp->b1_hi );
+	bs2bdp->q.gain  = Q30( bs2bdp->gain );
+} /* init_coef() */
+
+/* Coefficients by sample rate and crossfeed level shared by all
+ * instances. Direct mapped, a colliding set replaces an older one.
+ */
+#define COEF_CACHE_SIZE 64
+
+static struct
+{
+	int     used;
+	t_bs2bd coef;   /* Only srate, level and coefficients are set */
+} coef_cache[ COEF_CACHE_SIZE ];
+
+static bs2b_mutex coef_lock = BS2B_MUTEX_INIT;
+
+/* Copies coefficients of the same sample rate and level */
+static void copy_coef( t_bs2bdp to, t_bs2bd const *from )
+{
+	to->a0_lo = from->a0_lo;
+	to->b1_lo = from->b1_lo;
+	to->a0_hi = from->a0_hi;
+	to->a1_hi = from->a1_hi;
+	to->b1_hi = from->b1_hi;
+	to->gain  = from->gain;
+	to->f     = from->f;
+	to->q     = from->q;
+} /* copy_coef() */
+
+/* Return 1 if coefficients are set from bs2b_presets[] */
+static int init_preset( t_bs2bdp bs2bdp )
+{
+	t_bs2b_preset const *p = bs2b_presets;
+	int                 n = sizeof( bs2b_presets ) / sizeof( bs2b_presets[ 0 ] );
+
+	for( ; n > 0; n--, p++ )
+	{
+		if( p->srate == bs2bdp->srate && p->level == bs2bdp->level )
+		{
+			bs2bdp->a0_lo = p->a0_lo;
+			bs2bdp->b1_lo = p->b1_lo;
+			bs2bdp->a0_hi = p->a0_hi;
+			bs2bdp->a1_hi = p->a1_hi;
+			bs2bdp->b1_hi = p->b1_hi;
+			bs2bdp->gain  = p->gain;
+
+			bs2bdp->f.a0_lo = ( float )p->a0_lo;
+			bs2bdp->f.b1_lo = ( float )p->b1_lo;
+			bs2bdp->f.a0_hi = ( float )p->a0_hi;
+			bs2bdp->f.a1_hi = ( float )p->a1_hi;
+			bs2bdp->f.b1_hi = ( float )p->b1_hi;
+			bs2bdp->f.gain  = ( float )p->gain;
+
+			bs2bdp->q.a0_lo = p->q_a0_lo;
+			bs2bdp->q.b1_lo = p->q_b1_lo;
+			bs2bdp->q.a0_hi = p->q_a0_hi;
+			bs2bdp->q.a1_hi = p->q_a1_hi;
+			bs2bdp->q.b1_hi = p->q_b1_hi;
+			bs2bdp->q.gain  = p->q_gain;
+
+			return 1;
+		}
+	}
+
+	return 0;
+} /* init_preset() */
+
+/* Sets coefficients from presets or computes them, without the shared
+ * cache and its lock
+ */
+static void init_nolock( t_bs2bdp bs2bdp )
+{
+	check_params( bs2bdp );
+
+	bs2bdp->lazy = 0;
+
+	if( !init_preset( bs2bdp ) )
+		init_coef( bs2bdp );
+} /* init_nolock() */
+
+static void init( t_bs2bdp bs2bdp )
+{
+	uint32_t i;
+	int      hit;
+
+	check_params( bs2bdp );
+
+	bs2bdp->lazy = 0;
+
+	if( init_preset( bs2bdp ) ) return;
+
+	i = ( ( bs2bdp->srate * 31 + bs2bdp->level ) * 2654435761u ) >> 26;
+	i &= COEF_CACHE_SIZE - 1;
+
+	bs2b_mutex_lock( &coef_lock );
+	hit = coef_cache[ i ].used &&
+		coef_cache[ i ].coef.srate == bs2bdp->srate &&
+		coef_cache[ i ].coef.level == bs2bdp->level;
+	if( hit )
+		copy_coef( bs2bdp, &coef_cache[ i ].coef );
+	bs2b_mutex_unlock( &coef_lock );
+
+	if( !hit )
+	{
+		init_coef( bs2bdp );
+
+		bs2b_mutex_lock( &coef_lock );
+		coef_cache[ i ].used = 1;
+		coef_cache[ i ].coef.srate = bs2bdp->srate;
+		coef_cache[ i ].coef.level = bs2bdp->level;
+		copy_coef( &coef_cache[ i ].coef, bs2bdp );
+		bs2b_mutex_unlock( &coef_lock );
+	}
 } /* init() */
 
+/* Triple buffer of coefficient sets posted by bs2b_post_level().
+ * The control thread fills 'back' and swaps it with the middle set,
+ * crossfeeding swaps 'front' with the middle set marked as fresh.
+ */
+#define POST_FRESH 4
+
+/* Number of blocks to ramp coefficients over, BS2B_FLAG_RAMP */
+#define RAMP_BLOCKS 8
+
+typedef struct
+{
+	t_bs2bd     set[ 3 ];   /* Only srate, level and coefficients are set */
+	bs2b_atomic middle;     /* Index of the middle set | POST_FRESH */
+	bs2b_atomic posted;     /* Something was posted */
+	int         back;       /* Owned by the control thread */
+	int         front;      /* Owned by crossfeeding */
+	t_bs2bd     from;       /* Coefficients the ramp started from */
+	int         ramp;       /* Blocks left to ramp */
+} t_bs2b_post;
+
+/* Sets coefficients to 'w' * 'from' + ( 1 - 'w' ) * 'to' */
+static void mix_coef( t_bs2bdp bs2bdp,
+	t_bs2bd const *from, t_bs2bd const *to, double w )
+{
+	bs2bdp->a0_lo = to->a0_lo + ( from->a0_lo - to->a0_lo ) * w;
+	bs2bdp->b1_lo = to->b1_lo + ( from->b1_lo - to->b1_lo ) * w;
+	bs2bdp->a0_hi = to->a0_hi + ( from->a0_hi - to->a0_hi ) * w;
+	bs2bdp->a1_hi = to->a1_hi + ( from->a1_hi - to->a1_hi ) * w;
+	bs2bdp->b1_hi = to->b1_hi + ( from->b1_hi - to->b1_hi ) * w;
+	bs2bdp->gain  = to->gain  + ( from->gain  - to->gain  ) * w;
+
+	bs2bdp->f.a0_lo = ( float )bs2bdp->a0_lo;
+	bs2bdp->f.b1_lo = ( float )bs2bdp->b1_lo;
+	bs2bdp->f.a0_hi = ( float )bs2bdp->a0_hi;
+	bs2bdp->f.a1_hi = ( float )bs2bdp->a1_hi;
+	bs2bdp->f.b1_hi = ( float )bs2bdp->b1_hi;
+	bs2bdp->f.gain  = ( float )bs2bdp->gain;
+
+	bs2bdp->q.a0_lo = Q30( bs2bdp->a0_lo );
+	bs2bdp->q.b1_lo = Q30( bs2bdp->b1_lo );
+	bs2bdp->q.a0_hi = Q30( bs2bdp->a0_hi );
+	bs2bdp->q.a1_hi = Q30( bs2bdp->a1_hi );
+	bs2bdp->q.b1_hi = Q30( bs2bdp->b1_hi );
+	bs2bdp->q.gain  = Q30( bs2bdp->gain );
+} /* mix_coef() */
+
+/* Takes fresh posted coefficients and steps a ramp, once per block.
+ * Sets posted before a change of sample rate are dropped.
+ */
+static void take_post( t_bs2bdp bs2bdp )
+{
+	t_bs2b_post *post = ( t_bs2b_post * )bs2bdp->post;
+	t_bs2bd     *to;
+
+	if( bs2b_atomic_load( &post->middle ) & POST_FRESH )
+	{
+		post->front = bs2b_atomic_exchange( &post->middle, post->front ) & 3;
+		to = &post->set[ post->front ];
+
+		if( to->srate != bs2bdp->srate )
+			post->ramp = 0;
+		else if( bs2bdp->flags & BS2B_FLAG_RAMP )
+		{
+			bs2bdp->level = to->level;
+			copy_coef( &post->from, bs2bdp );
+			post->ramp = RAMP_BLOCKS;
+		}
+		else
+		{
+			bs2bdp->level = to->level;
+			copy_coef( bs2bdp, to );
+			post->ramp = 0;
+		}
+	}
+
+	if( post->ramp > 0 )
+	{
+		post->ramp--;
+
+		if( post->ramp > 0 )
+			mix_coef( bs2bdp, &post->from, &post->set[ post->front ],
+				( double )post->ramp / RAMP_BLOCKS );
+		else
+			copy_coef( bs2bdp, &post->set[ post->front ] );
+	}
+} /* take_post() */
+
+/* Coefficients set directly are not ramped over */
+static void stop_ramp( t_bs2bdp bs2bdp )
+{
+	( ( t_bs2b_post * )bs2bdp->post )->ramp = 0;
+} /* stop_ramp() */
+
+/* Takes fresh posted coefficients at once, a ramp in progress is
+ * finished
+ */
+static void finish_post( t_bs2bdp bs2bdp )
+{
+	t_bs2b_post *post = ( t_bs2b_post * )bs2bdp->post;
+
+	take_post( bs2bdp );
+
+	if( post->ramp > 0 )
+	{
+		copy_coef( bs2bdp, &post->set[ post->front ] );
+		post->ramp = 0;
+	}
+} /* finish_post() */
+
 /* Single pole IIR filter.
  * O[n] = a0*I[n] + a1*I[n-1] + b1*O[n-1]
  */
@@ -214,941 +483,2487 @@ static void cross_feed_d( t_bs2bdp bs2bdp, double *sample )
 	sample[ 1 ] *= bs2bdp->gain;
 } /* cross_feed_d() */
 
-/* Exported functions.
- * See descriptions in "bs2b.h"
- */
+/* Single precision lowpass filter */
+#define lo_filter_f( in, out_1 ) \
+	( bs2bdp->f.a0_lo * in + bs2bdp->f.b1_lo * out_1 )
 
-t_bs2bdp bs2b_open( void )
-{
-	t_bs2bdp bs2bdp = NULL;
+/* Single precision highboost filter */
+#define hi_filter_f( in, in_1, out_1 ) \
+	( bs2bdp->f.a0_hi * in + bs2bdp->f.a1_hi * in_1 + bs2bdp->f.b1_hi * out_1 )
 
-	if( NULL != ( bs2bdp = malloc( sizeof( t_bs2bd ) ) ) )
-	{
-		memset( bs2bdp, 0, sizeof( t_bs2bd ) );
-		bs2b_set_srate( bs2bdp, BS2B_DEFAULT_SRATE );
-	}
+static void cross_feed_f( t_bs2bdp bs2bdp, float *sample )
+{
+	/* Lowpass filter */
+	bs2bdp->lfsf.lo[ 0 ] = lo_filter_f( sample[ 0 ], bs2bdp->lfsf.lo[ 0 ] );
+	bs2bdp->lfsf.lo[ 1 ] = lo_filter_f( sample[ 1 ], bs2bdp->lfsf.lo[ 1 ] );
 
-	return bs2bdp;
-} /* bs2b_open() */
+	/* Highboost filter */
+	bs2bdp->lfsf.hi[ 0 ] =
+		hi_filter_f( sample[ 0 ], bs2bdp->lfsf.asis[ 0 ], bs2bdp->lfsf.hi[ 0 ] );
+	bs2bdp->lfsf.hi[ 1 ] =
+		hi_filter_f( sample[ 1 ], bs2bdp->lfsf.asis[ 1 ], bs2bdp->lfsf.hi[ 1 ] );
+	bs2bdp->lfsf.asis[ 0 ] = sample[ 0 ];
+	bs2bdp->lfsf.asis[ 1 ] = sample[ 1 ];
 
-void bs2b_close( t_bs2bdp bs2bdp )
-{
-	free( bs2bdp );
-} /* bs2b_close() */
+	/* Crossfeed */
+	sample[ 0 ] = bs2bdp->lfsf.hi[ 0 ] + bs2bdp->lfsf.lo[ 1 ];
+	sample[ 1 ] = bs2bdp->lfsf.hi[ 1 ] + bs2bdp->lfsf.lo[ 0 ];
 
-void bs2b_set_level( t_bs2bdp bs2bdp, uint32_t level )
-{
-	if( NULL == bs2bdp ) return;
+	/* Bass boost cause allpass attenuation */
+	sample[ 0 ] *= bs2bdp->f.gain;
+	sample[ 1 ] *= bs2bdp->f.gain;
+} /* cross_feed_f() */
+
+/* Q30 fixed-point filters. Coefficients and samples are Q30,
+ * 64 bit products are rounded back to Q30.
+ * A Q30 sample does not exceed 1.0 ( 2^30 ), filter buffers and
+ * crossfeed stay within 2.0 ( 2^31 ) for all levels.
+ */
+#define round_q( x ) ( ( int32_t )( ( ( x ) + ( 1 << 29 ) ) >> 30 ) )
+#define mul_q( a, b ) ( ( bs2b_int64 )( a ) * ( b ) )
 
-	if( level == bs2bdp->level ) return;
+/* Fixed-point lowpass filter */
+#define lo_filter_q( in, out_1 ) \
+	round_q( mul_q( bs2bdp->q.a0_lo, in ) + mul_q( bs2bdp->q.b1_lo, out_1 ) )
 
-	bs2bdp->level = level;
-	init( bs2bdp );
-} /* bs2b_set_level() */
+/* Fixed-point highboost filter */
+#define hi_filter_q( in, in_1, out_1 ) \
+	round_q( mul_q( bs2bdp->q.a0_hi, in ) + mul_q( bs2bdp->q.a1_hi, in_1 ) + \
+	mul_q( bs2bdp->q.b1_hi, out_1 ) )
 
-uint32_t bs2b_get_level( t_bs2bdp bs2bdp )
+static void cross_feed_q( t_bs2bdp bs2bdp, int32_t *sample )
 {
-	return bs2bdp->level;
-} /* bs2b_get_level() */
+	/* Lowpass filter */
+	bs2bdp->lfsq.lo[ 0 ] = lo_filter_q( sample[ 0 ], bs2bdp->lfsq.lo[ 0 ] );
+	bs2bdp->lfsq.lo[ 1 ] = lo_filter_q( sample[ 1 ], bs2bdp->lfsq.lo[ 1 ] );
 
-void bs2b_set_level_fcut( t_bs2bdp bs2bdp, int fcut )
+	/* Highboost filter */
+	bs2bdp->lfsq.hi[ 0 ] =
+		hi_filter_q( sample[ 0 ], bs2bdp->lfsq.asis[ 0 ], bs2bdp->lfsq.hi[ 0 ] );
+	bs2bdp->lfsq.hi[ 1 ] =
+		hi_filter_q( sample[ 1 ], bs2bdp->lfsq.asis[ 1 ], bs2bdp->lfsq.hi[ 1 ] );
+	bs2bdp->lfsq.asis[ 0 ] = sample[ 0 ];
+	bs2bdp->lfsq.asis[ 1 ] = sample[ 1 ];
+
+	/* Crossfeed and bass boost cause allpass attenuation */
+	sample[ 0 ] = round_q( mul_q(
+		bs2bdp->lfsq.hi[ 0 ] + bs2bdp->lfsq.lo[ 1 ], bs2bdp->q.gain ) );
+	sample[ 1 ] = round_q( mul_q(
+		bs2bdp->lfsq.hi[ 1 ] + bs2bdp->lfsq.lo[ 0 ], bs2bdp->q.gain ) );
+} /* cross_feed_q() */
+
+/* Scalar reference kernels */
+
+static void scalar_cross_feed_d( t_bs2bdp bs2bdp,
+	double const *in, double *out, int n )
 {
-	uint32_t level;
-
-	if( NULL == bs2bdp ) return;
+	if( n > 0 )
+	{
+		while( n-- )
+		{
+			out[ 0 ] = in[ 0 ];
+			out[ 1 ] = in[ 1 ];
+			cross_feed_d( bs2bdp, out );
 
-	level = bs2bdp->level;
-	level &= 0xffff0000;
-	level |= ( uint32_t )fcut;
-	bs2b_set_level( bs2bdp, level );
-} /* bs2b_set_level_fcut() */
+			in  += 2;
+			out += 2;
+		} /* while */
+	} /* if */
+} /* scalar_cross_feed_d() */
 
-int bs2b_get_level_fcut( t_bs2bdp bs2bdp )
+static void scalar_cross_feed_f( t_bs2bdp bs2bdp,
+	float const *in, float *out, int n )
 {
-	return( ( int )( bs2bdp->level & 0xffff ) );
-} /* bs2b_get_level_fcut() */
+	if( n > 0 )
+	{
+		while( n-- )
+		{
+			out[ 0 ] = in[ 0 ];
+			out[ 1 ] = in[ 1 ];
+			cross_feed_f( bs2bdp, out );
 
-void bs2b_set_level_feed( t_bs2bdp bs2bdp, int feed )
-{
-	uint32_t level;
+			in  += 2;
+			out += 2;
+		} /* while */
+	} /* if */
+} /* scalar_cross_feed_f() */
 
-	if( NULL == bs2bdp ) return;
+/* Lanes one by one in the order of operations of cross_feed_f() */
+static void scalar_cross_feed_batch_f( t_bs2b_batchp batch, size_t first,
+	float * const *sample, int n )
+{
+	float  a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain;
+	float  asis[ 2 ], lo[ 2 ], hi[ 2 ];
+	float  *y;
+	size_t k;
+	int    i, c;
 
-	level = bs2bdp->level;
-	level &= ( uint32_t )0xffff;
-	level |= ( uint32_t )feed << 16;
-	bs2b_set_level( bs2bdp, level );
-} /* bs2b_set_level_feed() */
+	for( k = first; k < first + BS2B_BATCH_LANES; k++ )
+	{
+		a0_lo = batch->a0_lo[ k ];
+		b1_lo = batch->b1_lo[ k ];
+		a0_hi = batch->a0_hi[ k ];
+		a1_hi = batch->a1_hi[ k ];
+		b1_hi = batch->b1_hi[ k ];
+		gain  = batch->gain[ k ];
+
+		for( c = 0; c < 2; c++ )
+		{
+			asis[ c ] = batch->asis[ c ][ k ];
+			lo[ c ]   = batch->lo[ c ][ k ];
+			hi[ c ]   = batch->hi[ c ][ k ];
+		}
 
-int bs2b_get_level_feed( t_bs2bdp bs2bdp )
+		for( i = 0, y = sample[ k - first ]; i < n; i++, y += 2 )
+		{
+			for( c = 0; c < 2; c++ )
+			{
+				lo[ c ] = a0_lo * y[ c ] + b1_lo * lo[ c ];
+				hi[ c ] = a0_hi * y[ c ] + a1_hi * asis[ c ] + b1_hi * hi[ c ];
+				asis[ c ] = y[ c ];
+			}
+
+			y[ 0 ] = hi[ 0 ] + lo[ 1 ];
+			y[ 1 ] = hi[ 1 ] + lo[ 0 ];
+			y[ 0 ] *= gain;
+			y[ 1 ] *= gain;
+		} /* for */
+
+		for( c = 0; c < 2; c++ )
+		{
+			batch->asis[ c ][ k ] = asis[ c ];
+			batch->lo[ c ][ k ]   = lo[ c ];
+			batch->hi[ c ][ k ]   = hi[ c ];
+		}
+	} /* for */
+} /* scalar_cross_feed_batch_f() */
+
+/* 16 bit samples are Q15, truncated back like by the double engine. */
+static void scalar_cross_feed_s16q( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, int n )
 {
-	return( ( int )( ( bs2bdp->level & 0xffff0000 ) >> 16 ) );
-} /* bs2b_get_level_feed() */
+	int32_t sample[ 2 ];
+	int     i;
 
-int bs2b_get_level_delay( t_bs2bdp bs2bdp )
-{
-	int fcut;
-	
-	fcut = bs2bdp->level & 0xffff; /* get cut frequency */
+	while( n-- > 0 )
+	{
+		sample[ 0 ] = ( int32_t )*in++ * 32768;
+		sample[ 1 ] = ( int32_t )*in++ * 32768;
 
-	if( ( fcut > BS2B_MAXFCUT ) || ( fcut < BS2B_MINFCUT ) )
-		return 0;
+		cross_feed_q( bs2bdp, sample );
 
-	return bs2b_level_delay( fcut );
-} /* bs2b_get_level_delay() */
+		for( i = 0; i < 2; i++ )
+		{
+			sample[ i ] /= 32768;
 
-void bs2b_set_srate( t_bs2bdp bs2bdp, uint32_t srate )
+			/* Clipping of overloaded samples */
+			if( sample[ i ] > 32767 ) sample[ i ] = 32767;
+			if( sample[ i ] < -32768 ) sample[ i ] = -32768;
+
+			*out++ = ( int16_t )sample[ i ];
+		}
+	} /* while */
+} /* scalar_cross_feed_s16q() */
+
+/* 32 bit samples are Q31, the lowest bit is dropped. */
+static void scalar_cross_feed_s32q( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, int n )
 {
-	if( NULL == bs2bdp ) return;
+	int32_t sample[ 2 ];
+	int     i;
 
-	if( srate == bs2bdp->srate ) return;
+	while( n-- > 0 )
+	{
+		sample[ 0 ] = *in++ >> 1;
+		sample[ 1 ] = *in++ >> 1;
 
-	bs2bdp->srate = srate;
-	init( bs2bdp );
-	bs2b_clear( bs2bdp );
-} /* bs2b_set_srate() */
+		cross_feed_q( bs2bdp, sample );
 
-uint32_t bs2b_get_srate( t_bs2bdp bs2bdp )
-{
-	return bs2bdp->srate;
-} /* bs2b_get_srate() */
+		for( i = 0; i < 2; i++ )
+		{
+			/* Clipping of overloaded samples */
+			if( sample[ i ] > 1073741823 ) sample[ i ] = 1073741823;
+			if( sample[ i ] < -1073741824 ) sample[ i ] = -1073741824;
 
-void bs2b_clear( t_bs2bdp bs2bdp )
-{
-	if( NULL == bs2bdp ) return;
-	memset( &bs2bdp->lfs, 0, sizeof( bs2bdp->lfs ) );
-} /* bs2b_clear() */
+			*out++ = sample[ i ] * 2;
+		}
+	} /* while */
+} /* scalar_cross_feed_s32q() */
 
-int bs2b_is_clear( t_bs2bdp bs2bdp )
+static void swap32( void const *in, void *out, int n )
 {
-	int loopv = sizeof( bs2bdp->lfs );
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t *y = ( uint32_t * )out;
 
-	while( loopv )
+	while( n-- )
 	{
-		if( ( ( char * )&bs2bdp->lfs )[ --loopv ] != 0 )
-			return 0;
+		*y++ = BS2B_SWAP32( *x );
+		x++;
 	}
+} /* swap32() */
 
-	return 1;
-} /* bs2b_is_clear() */
-
-char const *bs2b_runtime_version( void )
+static void zip_d( double const *left, double const *right,
+	double *out, int n )
 {
-	return BS2B_VERSION_STR;
-} /* bs2b_runtime_version() */
+	while( n-- )
+	{
+		*out++ = *left++;
+		*out++ = *right++;
+	}
+} /* zip_d() */
 
-uint32_t bs2b_runtime_version_int( void )
+static void zip_f( float const *left, float const *right,
+	float *out, int n )
 {
-	return BS2B_VERSION_INT;
-} /* bs2b_runtime_version_int() */
+	while( n-- )
+	{
+		*out++ = *left++;
+		*out++ = *right++;
+	}
+} /* zip_f() */
 
-void bs2b_cross_feed_d( t_bs2bdp bs2bdp, double *sample, int n )
+static void unzip_d( double const *in, double *left, double *right, int n )
 {
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			cross_feed_d( bs2bdp, sample );
-			
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_d() */
+		*left++  = *in++;
+		*right++ = *in++;
+	}
+} /* unzip_d() */
 
-void bs2b_cross_feed_dbe( t_bs2bdp bs2bdp, double *sample, int n )
+static void unzip_f( float const *in, float *left, float *right, int n )
 {
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifndef WORDS_BIGENDIAN
-			int64swap( ( uint32_t * )sample );
-			int64swap( ( uint32_t * )( sample + 1 ) );
-			#endif
-
-			cross_feed_d( bs2bdp, sample );
-
-			#ifndef WORDS_BIGENDIAN
-			int64swap( ( uint32_t * )sample );
-			int64swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+		*left++  = *in++;
+		*right++ = *in++;
+	}
+} /* unzip_f() */
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_dbe() */
+/* No portable control of denormals,
+ * the state is snapped to zero instead, see snap_state()
+ */
+static unsigned int flush_fpu( void )
+{
+	return 0;
+} /* flush_fpu() */
 
-void bs2b_cross_feed_dle( t_bs2bdp bs2bdp, double *sample, int n )
+static void restore_fpu( unsigned int mode )
 {
-	if( n > 0 )
-	{
-		while( n-- )
-		{
-			#ifdef WORDS_BIGENDIAN
-			int64swap( ( uint32_t * )sample );
-			int64swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+	( void )mode;
+} /* restore_fpu() */
 
-			cross_feed_d( bs2bdp, sample );
+static int is_zero( void const *in, int n )
+{
+	unsigned char const *x = ( unsigned char const * )in;
+	unsigned char       acc = 0;
 
-			#ifdef WORDS_BIGENDIAN
-			int64swap( ( uint32_t * )sample );
-			int64swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+	while( n-- )
+		acc |= *x++;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_dle() */
+	return 0 == acc;
+} /* is_zero() */
 
-void bs2b_cross_feed_f( t_bs2bdp bs2bdp, float *sample, int n )
+static void decode_dx( void const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t y[ 2 ];
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
-
-			cross_feed_d( bs2bdp, sample_d );
+		y[ 0 ] = x[ 0 ];
+		y[ 1 ] = x[ 1 ];
+		int64swap( y );
+		memcpy( out++, y, sizeof( double ) );
+		x += 2;
+	}
+} /* decode_dx() */
 
-			sample[ 0 ] = ( float )sample_d[ 0 ];
-			sample[ 1 ] = ( float )sample_d[ 1 ];
+static void encode_dx( double const *in, void *out, int n )
+{
+	uint32_t *y = ( uint32_t * )out;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_f() */
+	while( n-- )
+	{
+		memcpy( y, in++, sizeof( double ) );
+		int64swap( y );
+		y += 2;
+	}
+} /* encode_dx() */
 
-void bs2b_cross_feed_fbe( t_bs2bdp bs2bdp, float *sample, int n )
+static void decode_f( void const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	float const *x = ( float const * )in;
 
-	if( n > 0 )
-	{
-		while( n-- )
-		{
-			#ifndef WORDS_BIGENDIAN
-			int32swap( ( uint32_t * )sample );
-			int32swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+	while( n-- )
+		*out++ = ( double )*x++;
+} /* decode_f() */
 
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
-
-			cross_feed_d( bs2bdp, sample_d );
+static void encode_f( double const *in, void *out, int n )
+{
+	float *y = ( float * )out;
 
-			sample[ 0 ] = ( float )sample_d[ 0 ];
-			sample[ 1 ] = ( float )sample_d[ 1 ];
+	while( n-- )
+		*y++ = ( float )*in++;
+} /* encode_f() */
 
-			#ifndef WORDS_BIGENDIAN
-			int32swap( ( uint32_t * )sample );
-			int32swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+static void decode_fx( void const *in, double *out, int n )
+{
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t y;
+	float    f;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_fbe() */
+	while( n-- )
+	{
+		y = *x++;
+		int32swap( &y );
+		memcpy( &f, &y, sizeof( float ) );
+		*out++ = ( double )f;
+	}
+} /* decode_fx() */
 
-void bs2b_cross_feed_fle( t_bs2bdp bs2bdp, float *sample, int n )
+static void encode_fx( double const *in, void *out, int n )
 {
-	double sample_d[ 2 ];
+	uint32_t *y = ( uint32_t * )out;
+	float    f;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifdef WORDS_BIGENDIAN
-			int32swap( ( uint32_t * )sample );
-			int32swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+		f = ( float )*in++;
+		memcpy( y, &f, sizeof( float ) );
+		int32swap( y++ );
+	}
+} /* encode_fx() */
 
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+static void decode_s32( void const *in, double *out, int n )
+{
+	int32_t const *x = ( int32_t const * )in;
 
-			cross_feed_d( bs2bdp, sample_d );
+	while( n-- )
+		*out++ = ( double )*x++;
+} /* decode_s32() */
 
-			sample[ 0 ] = ( float )sample_d[ 0 ];
-			sample[ 1 ] = ( float )sample_d[ 1 ];
+static void encode_s32( double const *in, void *out, int n )
+{
+	int32_t *y = ( int32_t * )out;
+	double  x;
 
-			#ifdef WORDS_BIGENDIAN
-			int32swap( ( uint32_t * )sample );
-			int32swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+	while( n-- )
+	{
+		x = *in++;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_fle() */
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT32_VALUE ) x = MAX_INT32_VALUE;
+		if( x < MIN_INT32_VALUE ) x = MIN_INT32_VALUE;
 
-#define MAX_INT32_VALUE  2147483647.0
-#define MIN_INT32_VALUE -2147483648.0
-#define MAX_INT24_VALUE     8388607.0
-#define MIN_INT24_VALUE    -8388608.0
-#define MAX_INT16_VALUE       32767.0
-#define MIN_INT16_VALUE      -32768.0
-#define MAX_INT8_VALUE          127.0
-#define MIN_INT8_VALUE         -128.0
+		*y++ = ( int32_t )x;
+	}
+} /* encode_s32() */
 
-void bs2b_cross_feed_s32( t_bs2bdp bs2bdp, int32_t *sample, int n )
+static void decode_s32x( void const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t y;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+		y = *x++;
+		int32swap( &y );
+		*out++ = ( double )( int32_t )y;
+	}
+} /* decode_s32x() */
 
-			cross_feed_d( bs2bdp, sample_d );
+static void encode_s32x( double const *in, void *out, int n )
+{
+	int32_t *y = ( int32_t * )out;
+	double  x;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT32_VALUE ) sample_d[ 0 ] = MAX_INT32_VALUE;
-			if( sample_d[ 0 ] < MIN_INT32_VALUE ) sample_d[ 0 ] = MIN_INT32_VALUE;
-			if( sample_d[ 1 ] > MAX_INT32_VALUE ) sample_d[ 1 ] = MAX_INT32_VALUE;
-			if( sample_d[ 1 ] < MIN_INT32_VALUE ) sample_d[ 1 ] = MIN_INT32_VALUE;
+	while( n-- )
+	{
+		x = *in++;
 
-			sample[ 0 ] = ( int32_t )sample_d[ 0 ];
-			sample[ 1 ] = ( int32_t )sample_d[ 1 ];
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT32_VALUE ) x = MAX_INT32_VALUE;
+		if( x < MIN_INT32_VALUE ) x = MIN_INT32_VALUE;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s32() */
+		*y = ( int32_t )x;
+		int32swap( ( uint32_t * )y++ );
+	}
+} /* encode_s32x() */
 
-void bs2b_cross_feed_u32( t_bs2bdp bs2bdp, uint32_t *sample, int n )
+static void decode_u32( void const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	uint32_t const *x = ( uint32_t const * )in;
 
-	if( n > 0 )
-	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = ( double )( ( int32_t )( sample[ 0 ] ^ 0x80000000 ) );
-			sample_d[ 1 ] = ( double )( ( int32_t )( sample[ 1 ] ^ 0x80000000 ) );
+	while( n-- )
+		*out++ = ( double )( ( int32_t )( *x++ ^ 0x80000000 ) );
+} /* decode_u32() */
 
-			cross_feed_d( bs2bdp, sample_d );
+static void encode_u32( double const *in, void *out, int n )
+{
+	uint32_t *y = ( uint32_t * )out;
+	double   x;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT32_VALUE ) sample_d[ 0 ] = MAX_INT32_VALUE;
-			if( sample_d[ 0 ] < MIN_INT32_VALUE ) sample_d[ 0 ] = MIN_INT32_VALUE;
-			if( sample_d[ 1 ] > MAX_INT32_VALUE ) sample_d[ 1 ] = MAX_INT32_VALUE;
-			if( sample_d[ 1 ] < MIN_INT32_VALUE ) sample_d[ 1 ] = MIN_INT32_VALUE;
+	while( n-- )
+	{
+		x = *in++;
 
-			sample[ 0 ] = ( ( uint32_t )sample_d[ 0 ] ) ^ 0x80000000;
-			sample[ 1 ] = ( ( uint32_t )sample_d[ 1 ] ) ^ 0x80000000;
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT32_VALUE ) x = MAX_INT32_VALUE;
+		if( x < MIN_INT32_VALUE ) x = MIN_INT32_VALUE;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u32() */
+		*y++ = ( ( uint32_t )x ) ^ 0x80000000;
+	}
+} /* encode_u32() */
 
-void bs2b_cross_feed_s32be( t_bs2bdp bs2bdp, int32_t *sample, int n )
+static void decode_u32x( void const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t y;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifndef WORDS_BIGENDIAN
-			int32swap( ( uint32_t * )sample );
-			int32swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+		y = *x++;
+		int32swap( &y );
+		*out++ = ( double )( ( int32_t )( y ^ 0x80000000 ) );
+	}
+} /* decode_u32x() */
 
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+static void encode_u32x( double const *in, void *out, int n )
+{
+	uint32_t *y = ( uint32_t * )out;
+	double   x;
 
-			cross_feed_d( bs2bdp, sample_d );
+	while( n-- )
+	{
+		x = *in++;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT32_VALUE ) sample_d[ 0 ] = MAX_INT32_VALUE;
-			if( sample_d[ 0 ] < MIN_INT32_VALUE ) sample_d[ 0 ] = MIN_INT32_VALUE;
-			if( sample_d[ 1 ] > MAX_INT32_VALUE ) sample_d[ 1 ] = MAX_INT32_VALUE;
-			if( sample_d[ 1 ] < MIN_INT32_VALUE ) sample_d[ 1 ] = MIN_INT32_VALUE;
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT32_VALUE ) x = MAX_INT32_VALUE;
+		if( x < MIN_INT32_VALUE ) x = MIN_INT32_VALUE;
 
-			sample[ 0 ] = ( int32_t )sample_d[ 0 ];
-			sample[ 1 ] = ( int32_t )sample_d[ 1 ];
+		*y = ( ( uint32_t )x ) ^ 0x80000000;
+		int32swap( y++ );
+	}
+} /* encode_u32x() */
 
-			#ifndef WORDS_BIGENDIAN
-			int32swap( ( uint32_t * )sample );
-			int32swap( ( uint32_t * )( sample + 1 ) );
-			#endif
+static void decode_s16( void const *in, double *out, int n )
+{
+	int16_t const *x = ( int16_t const * )in;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s32be() */
+	while( n-- )
+		*out++ = ( double )*x++;
+} /* decode_s16() */
 
-void bs2b_cross_feed_u32be( t_bs2bdp bs2bdp, uint32_t *sample, int n )
+static void encode_s16( double const *in, void *out, int n )
 {
-	double sample_d[ 2 ];
+	int16_t *y = ( int16_t * )out;
+	double  x;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifndef WORDS_BIGENDIAN
-			int32swap( sample );
-			int32swap( sample + 1 );
-			#endif
-
-			sample_d[ 0 ] = ( double )( ( int32_t )( sample[ 0 ] ^ 0x80000000 ) );
-			sample_d[ 1 ] = ( double )( ( int32_t )( sample[ 1 ] ^ 0x80000000 ) );
-
-			cross_feed_d( bs2bdp, sample_d );
-
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT32_VALUE ) sample_d[ 0 ] = MAX_INT32_VALUE;
-			if( sample_d[ 0 ] < MIN_INT32_VALUE ) sample_d[ 0 ] = MIN_INT32_VALUE;
-			if( sample_d[ 1 ] > MAX_INT32_VALUE ) sample_d[ 1 ] = MAX_INT32_VALUE;
-			if( sample_d[ 1 ] < MIN_INT32_VALUE ) sample_d[ 1 ] = MIN_INT32_VALUE;
-
-			sample[ 0 ] = ( ( uint32_t )sample_d[ 0 ] ) ^ 0x80000000;
-			sample[ 1 ] = ( ( uint32_t )sample_d[ 1 ] ) ^ 0x80000000;
+		x = *in++;
 
-			#ifndef WORDS_BIGENDIAN
-			int32swap( sample );
-			int32swap( sample + 1 );
-			#endif
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT16_VALUE ) x = MAX_INT16_VALUE;
+		if( x < MIN_INT16_VALUE ) x = MIN_INT16_VALUE;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u32be() */
+		*y++ = ( int16_t )x;
+	}
+} /* encode_s16() */
 
-void bs2b_cross_feed_s32le( t_bs2bdp bs2bdp, int32_t *sample, int n )
+static void decode_s16x( void const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	uint16_t const *x = ( uint16_t const * )in;
+	uint16_t y;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifdef WORDS_BIGENDIAN
-			int32swap( sample );
-			int32swap( sample + 1 );
-			#endif
+		y = *x++;
+		int16swap( &y );
+		*out++ = ( double )( int16_t )y;
+	}
+} /* decode_s16x() */
 
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+static void encode_s16x( double const *in, void *out, int n )
+{
+	int16_t *y = ( int16_t * )out;
+	double  x;
 
-			cross_feed_d( bs2bdp, sample_d );
+	while( n-- )
+	{
+		x = *in++;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT32_VALUE ) sample_d[ 0 ] = MAX_INT32_VALUE;
-			if( sample_d[ 0 ] < MIN_INT32_VALUE ) sample_d[ 0 ] = MIN_INT32_VALUE;
-			if( sample_d[ 1 ] > MAX_INT32_VALUE ) sample_d[ 1 ] = MAX_INT32_VALUE;
-			if( sample_d[ 1 ] < MIN_INT32_VALUE ) sample_d[ 1 ] = MIN_INT32_VALUE;
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT16_VALUE ) x = MAX_INT16_VALUE;
+		if( x < MIN_INT16_VALUE ) x = MIN_INT16_VALUE;
 
-			sample[ 0 ] = ( int32_t )sample_d[ 0 ];
-			sample[ 1 ] = ( int32_t )sample_d[ 1 ];
+		*y = ( int16_t )x;
+		int16swap( ( uint16_t * )y++ );
+	}
+} /* encode_s16x() */
 
-			#ifdef WORDS_BIGENDIAN
-			int32swap( sample );
-			int32swap( sample + 1 );
-			#endif
+static void decode_u16( void const *in, double *out, int n )
+{
+	uint16_t const *x = ( uint16_t const * )in;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s32le() */
+	while( n-- )
+		*out++ = ( double )( ( int16_t )( *x++ ^ 0x8000 ) );
+} /* decode_u16() */
 
-void bs2b_cross_feed_u32le( t_bs2bdp bs2bdp, uint32_t *sample, int n )
+static void encode_u16( double const *in, void *out, int n )
 {
-	double sample_d[ 2 ];
+	uint16_t *y = ( uint16_t * )out;
+	double   x;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifdef WORDS_BIGENDIAN
-			int32swap( sample );
-			int32swap( sample + 1 );
-			#endif
-
-			sample_d[ 0 ] = ( double )( ( int32_t )( sample[ 0 ] ^ 0x80000000 ) );
-			sample_d[ 1 ] = ( double )( ( int32_t )( sample[ 1 ] ^ 0x80000000 ) );
+		x = *in++;
 
-			cross_feed_d( bs2bdp, sample_d );
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT16_VALUE ) x = MAX_INT16_VALUE;
+		if( x < MIN_INT16_VALUE ) x = MIN_INT16_VALUE;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT32_VALUE ) sample_d[ 0 ] = MAX_INT32_VALUE;
-			if( sample_d[ 0 ] < MIN_INT32_VALUE ) sample_d[ 0 ] = MIN_INT32_VALUE;
-			if( sample_d[ 1 ] > MAX_INT32_VALUE ) sample_d[ 1 ] = MAX_INT32_VALUE;
-			if( sample_d[ 1 ] < MIN_INT32_VALUE ) sample_d[ 1 ] = MIN_INT32_VALUE;
-
-			sample[ 0 ] = ( ( uint32_t )sample_d[ 0 ] ) ^ 0x80000000;
-			sample[ 1 ] = ( ( uint32_t )sample_d[ 1 ] ) ^ 0x80000000;
+		*y++ = ( ( uint16_t )x ) ^ 0x8000;
+	}
+} /* encode_u16() */
 
-			#ifdef WORDS_BIGENDIAN
-			int32swap( sample );
-			int32swap( sample + 1 );
-			#endif
+static void decode_u16x( void const *in, double *out, int n )
+{
+	uint16_t const *x = ( uint16_t const * )in;
+	uint16_t y;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u32le() */
+	while( n-- )
+	{
+		y = *x++;
+		int16swap( &y );
+		*out++ = ( double )( ( int16_t )( y ^ 0x8000 ) );
+	}
+} /* decode_u16x() */
 
-void bs2b_cross_feed_s16( t_bs2bdp bs2bdp, int16_t *sample, int n )
+static void encode_u16x( double const *in, void *out, int n )
 {
-	double sample_d[ 2 ];
+	uint16_t *y = ( uint16_t * )out;
+	double   x;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+		x = *in++;
 
-			cross_feed_d( bs2bdp, sample_d );
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT16_VALUE ) x = MAX_INT16_VALUE;
+		if( x < MIN_INT16_VALUE ) x = MIN_INT16_VALUE;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT16_VALUE ) sample_d[ 0 ] = MAX_INT16_VALUE;
-			if( sample_d[ 0 ] < MIN_INT16_VALUE ) sample_d[ 0 ] = MIN_INT16_VALUE;
-			if( sample_d[ 1 ] > MAX_INT16_VALUE ) sample_d[ 1 ] = MAX_INT16_VALUE;
-			if( sample_d[ 1 ] < MIN_INT16_VALUE ) sample_d[ 1 ] = MIN_INT16_VALUE;
+		*y = ( ( uint16_t )x ) ^ 0x8000;
+		int16swap( y++ );
+	}
+} /* encode_u16x() */
 
-			sample[ 0 ] = ( int16_t )sample_d[ 0 ];
-			sample[ 1 ] = ( int16_t )sample_d[ 1 ];
+static void decode_s8( void const *in, double *out, int n )
+{
+	int8_t const *x = ( int8_t const * )in;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s16() */
+	while( n-- )
+		*out++ = ( double )*x++;
+} /* decode_s8() */
 
-void bs2b_cross_feed_u16( t_bs2bdp bs2bdp, uint16_t *sample, int n )
+static void encode_s8( double const *in, void *out, int n )
 {
-	double sample_d[ 2 ];
+	int8_t *y = ( int8_t * )out;
+	double x;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = ( double )( ( int16_t )( sample[ 0 ] ^ 0x8000 ) );
-			sample_d[ 1 ] = ( double )( ( int16_t )( sample[ 1 ] ^ 0x8000 ) );
+		x = *in++;
 
-			cross_feed_d( bs2bdp, sample_d );
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT8_VALUE ) x = MAX_INT8_VALUE;
+		if( x < MIN_INT8_VALUE ) x = MIN_INT8_VALUE;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT16_VALUE ) sample_d[ 0 ] = MAX_INT16_VALUE;
-			if( sample_d[ 0 ] < MIN_INT16_VALUE ) sample_d[ 0 ] = MIN_INT16_VALUE;
-			if( sample_d[ 1 ] > MAX_INT16_VALUE ) sample_d[ 1 ] = MAX_INT16_VALUE;
-			if( sample_d[ 1 ] < MIN_INT16_VALUE ) sample_d[ 1 ] = MIN_INT16_VALUE;
+		*y++ = ( int8_t )x;
+	}
+} /* encode_s8() */
 
-			sample[ 0 ] = ( ( uint16_t )sample_d[ 0 ] ) ^ 0x8000;
-			sample[ 1 ] = ( ( uint16_t )sample_d[ 1 ] ) ^ 0x8000;
+static void decode_u8( void const *in, double *out, int n )
+{
+	uint8_t const *x = ( uint8_t const * )in;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u16() */
+	while( n-- )
+		*out++ = ( double )( ( int8_t )( *x++ ^ 0x80 ) );
+} /* decode_u8() */
 
-void bs2b_cross_feed_s16be( t_bs2bdp bs2bdp, int16_t *sample, int n )
+static void encode_u8( double const *in, void *out, int n )
 {
-	double sample_d[ 2 ];
+	uint8_t *y = ( uint8_t * )out;
+	double  x;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifndef WORDS_BIGENDIAN
-			int16swap( ( uint16_t * )sample );
-			int16swap( ( uint16_t * )( sample + 1 ) );
-			#endif
+		x = *in++;
 
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT8_VALUE ) x = MAX_INT8_VALUE;
+		if( x < MIN_INT8_VALUE ) x = MIN_INT8_VALUE;
 
-			cross_feed_d( bs2bdp, sample_d );
+		*y++ = ( ( uint8_t )x ) ^ 0x80;
+	}
+} /* encode_u8() */
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT16_VALUE ) sample_d[ 0 ] = MAX_INT16_VALUE;
-			if( sample_d[ 0 ] < MIN_INT16_VALUE ) sample_d[ 0 ] = MIN_INT16_VALUE;
-			if( sample_d[ 1 ] > MAX_INT16_VALUE ) sample_d[ 1 ] = MAX_INT16_VALUE;
-			if( sample_d[ 1 ] < MIN_INT16_VALUE ) sample_d[ 1 ] = MIN_INT16_VALUE;
+static void decode_s24( void const *in, double *out, int n )
+{
+	bs2b_int24_t const *x = ( bs2b_int24_t const * )in;
 
-			sample[ 0 ] = ( int16_t )sample_d[ 0 ];
-			sample[ 1 ] = ( int16_t )sample_d[ 1 ];
+	while( n-- )
+		*out++ = int242double( x++ );
+} /* decode_s24() */
 
-			#ifndef WORDS_BIGENDIAN
-			int16swap( ( uint16_t * )sample );
-			int16swap( ( uint16_t * )( sample + 1 ) );
-			#endif
+static void encode_s24( double const *in, void *out, int n )
+{
+	bs2b_int24_t *y = ( bs2b_int24_t * )out;
+	double       x;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s16be() */
+	while( n-- )
+	{
+		x = *in++;
 
-void bs2b_cross_feed_u16be( t_bs2bdp bs2bdp, uint16_t *sample, int n )
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT24_VALUE ) x = MAX_INT24_VALUE;
+		if( x < MIN_INT24_VALUE ) x = MIN_INT24_VALUE;
+
+		double2int24( x, y++ );
+	}
+} /* encode_s24() */
+
+static void decode_s24x( void const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	bs2b_int24_t const *x = ( bs2b_int24_t const * )in;
+	bs2b_int24_t y;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifndef WORDS_BIGENDIAN
-			int16swap( sample );
-			int16swap( sample + 1 );
-			#endif
+		y = *x++;
+		sint24swap( &y );
+		*out++ = int242double( &y );
+	}
+} /* decode_s24x() */
 
-			sample_d[ 0 ] = ( double )( ( int16_t )( sample[ 0 ] ^ 0x8000 ) );
-			sample_d[ 1 ] = ( double )( ( int16_t )( sample[ 1 ] ^ 0x8000 ) );
+static void encode_s24x( double const *in, void *out, int n )
+{
+	bs2b_int24_t *y = ( bs2b_int24_t * )out;
+	double       x;
 
-			cross_feed_d( bs2bdp, sample_d );
+	while( n-- )
+	{
+		x = *in++;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT16_VALUE ) sample_d[ 0 ] = MAX_INT16_VALUE;
-			if( sample_d[ 0 ] < MIN_INT16_VALUE ) sample_d[ 0 ] = MIN_INT16_VALUE;
-			if( sample_d[ 1 ] > MAX_INT16_VALUE ) sample_d[ 1 ] = MAX_INT16_VALUE;
-			if( sample_d[ 1 ] < MIN_INT16_VALUE ) sample_d[ 1 ] = MIN_INT16_VALUE;
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT24_VALUE ) x = MAX_INT24_VALUE;
+		if( x < MIN_INT24_VALUE ) x = MIN_INT24_VALUE;
 
-			sample[ 0 ] = ( ( uint16_t )sample_d[ 0 ] ) ^ 0x8000;
-			sample[ 1 ] = ( ( uint16_t )sample_d[ 1 ] ) ^ 0x8000;
+		double2int24( x, y );
+		sint24swap( y++ );
+	}
+} /* encode_s24x() */
 
-			#ifndef WORDS_BIGENDIAN
-			int16swap( sample );
-			int16swap( sample + 1 );
-			#endif
+static void decode_u24( void const *in, double *out, int n )
+{
+	bs2b_uint24_t const *x = ( bs2b_uint24_t const * )in;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u16be() */
+	while( n-- )
+		*out++ = uint242double( x++ ) - MAX_INT24_VALUE - 1.0;
+} /* decode_u24() */
 
-void bs2b_cross_feed_s16le( t_bs2bdp bs2bdp, int16_t *sample, int n )
+static void encode_u24( double const *in, void *out, int n )
 {
-	double sample_d[ 2 ];
+	bs2b_uint24_t *y = ( bs2b_uint24_t * )out;
+	double        x;
 
-	if( n > 0 )
+	while( n-- )
 	{
-		while( n-- )
-		{
-			#ifdef WORDS_BIGENDIAN
-			int16swap( sample );
-			int16swap( sample + 1 );
-			#endif
+		x = *in++;
 
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT24_VALUE ) x = MAX_INT24_VALUE;
+		if( x < MIN_INT24_VALUE ) x = MIN_INT24_VALUE;
 
-			cross_feed_d( bs2bdp, sample_d );
+		double2uint24( x + MAX_INT24_VALUE + 1.0, y++ );
+	}
+} /* encode_u24() */
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT16_VALUE ) sample_d[ 0 ] = MAX_INT16_VALUE;
-			if( sample_d[ 0 ] < MIN_INT16_VALUE ) sample_d[ 0 ] = MIN_INT16_VALUE;
-			if( sample_d[ 1 ] > MAX_INT16_VALUE ) sample_d[ 1 ] = MAX_INT16_VALUE;
-			if( sample_d[ 1 ] < MIN_INT16_VALUE ) sample_d[ 1 ] = MIN_INT16_VALUE;
+static void decode_u24x( void const *in, double *out, int n )
+{
+	bs2b_uint24_t const *x = ( bs2b_uint24_t const * )in;
+	bs2b_uint24_t y;
 
-			sample[ 0 ] = ( int16_t )sample_d[ 0 ];
-			sample[ 1 ] = ( int16_t )sample_d[ 1 ];
+	while( n-- )
+	{
+		y = *x++;
+		int24swap( &y );
+		*out++ = uint242double( &y ) - MAX_INT24_VALUE - 1.0;
+	}
+} /* decode_u24x() */
 
-			#ifdef WORDS_BIGENDIAN
-			int16swap( sample );
-			int16swap( sample + 1 );
-			#endif
+static void encode_u24x( double const *in, void *out, int n )
+{
+	bs2b_uint24_t *y = ( bs2b_uint24_t * )out;
+	double        x;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s16le() */
+	while( n-- )
+	{
+		x = *in++;
 
-void bs2b_cross_feed_u16le( t_bs2bdp bs2bdp, uint16_t *sample, int n )
-{
-	double sample_d[ 2 ];
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT24_VALUE ) x = MAX_INT24_VALUE;
+		if( x < MIN_INT24_VALUE ) x = MIN_INT24_VALUE;
 
-	if( n > 0 )
+		double2uint24( x + MAX_INT24_VALUE + 1.0, y );
+		int24swap( y++ );
+	}
+} /* encode_u24x() */
+
+static t_bs2b_kernel const kernel_scalar =
+{
+	BS2B_KERNEL_SCALAR, "scalar",
+	scalar_cross_feed_d,
+	scalar_cross_feed_d, /* No look-ahead in scalar code */
+	scalar_cross_feed_f,
+	scalar_cross_feed_s16q,
+	scalar_cross_feed_s32q,
+	swap32,
+	zip_d,   zip_f,
+	unzip_d, unzip_f,
+	flush_fpu, restore_fpu,
+	is_zero,
+	scalar_cross_feed_batch_f,
 	{
-		while( n-- )
-		{
-			#ifdef WORDS_BIGENDIAN
-			int16swap( sample );
-			int16swap( sample + 1 );
-			#endif
+		decode_dx,
+		decode_f,   decode_fx,
+		decode_s32, decode_s32x, decode_u32, decode_u32x,
+		decode_s16, decode_s16x, decode_u16, decode_u16x,
+		decode_s8,  decode_u8,
+		decode_s24, decode_s24x, decode_u24, decode_u24x
+	},
+	{
+		encode_dx,
+		encode_f,   encode_fx,
+		encode_s32, encode_s32x, encode_u32, encode_u32x,
+		encode_s16, encode_s16x, encode_u16, encode_u16x,
+		encode_s8,  encode_u8,
+		encode_s24, encode_s24x, encode_u24, encode_u24x
+	}
+};
 
-			sample_d[ 0 ] = ( double )( ( int16_t )( sample[ 0 ] ^ 0x8000 ) );
-			sample_d[ 1 ] = ( double )( ( int16_t )( sample[ 1 ] ^ 0x8000 ) );
+/* Size of single sample by BS2B_FMT_* */
+static int const fmt_size[ BS2B_FMT_COUNT ] =
+{
+	8,
+	4, 4,
+	4, 4, 4, 4,
+	2, 2, 2, 2,
+	1, 1,
+	3, 3, 3, 3
+};
+
+/* Full scale of samples by format */
+static double const fmt_scale[ BS2B_FMT_COUNT ] =
+{
+	1.0,
+	1.0, 1.0,
+	-MIN_INT32_VALUE, -MIN_INT32_VALUE, -MIN_INT32_VALUE, -MIN_INT32_VALUE,
+	-MIN_INT16_VALUE, -MIN_INT16_VALUE, -MIN_INT16_VALUE, -MIN_INT16_VALUE,
+	-MIN_INT8_VALUE,  -MIN_INT8_VALUE,
+	-MIN_INT24_VALUE, -MIN_INT24_VALUE, -MIN_INT24_VALUE, -MIN_INT24_VALUE
+};
+
+/* 1 if zero bytes are silence by format, they are full scale negative
+ * samples of unsigned formats
+ */
+static int const fmt_zero_silent[ BS2B_FMT_COUNT ] =
+{
+	1,
+	1, 1,
+	1, 1, 0, 0,
+	1, 1, 0, 0,
+	1, 0,
+	1, 1, 0, 0
+};
+
+/* Selected kernels, see select_kernel() */
+static t_bs2b_kernel kernel;
+static int           kernel_ready = 0;
+
+/* Return the best kernel supported by CPU and OS. */
+static int cpu_kernel( void )
+{
+	#if defined( BS2B_HAVE_X86 ) && defined( __GNUC__ )
+	__builtin_cpu_init();
 
-			cross_feed_d( bs2bdp, sample_d );
+	if( __builtin_cpu_supports( "avx512f" ) &&
+		__builtin_cpu_supports( "avx512vl" ) &&
+		__builtin_cpu_supports( "avx512bw" ) &&
+		__builtin_cpu_supports( "avx512dq" ) )
+		return BS2B_KERNEL_AVX512;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT16_VALUE ) sample_d[ 0 ] = MAX_INT16_VALUE;
-			if( sample_d[ 0 ] < MIN_INT16_VALUE ) sample_d[ 0 ] = MIN_INT16_VALUE;
-			if( sample_d[ 1 ] > MAX_INT16_VALUE ) sample_d[ 1 ] = MAX_INT16_VALUE;
-			if( sample_d[ 1 ] < MIN_INT16_VALUE ) sample_d[ 1 ] = MIN_INT16_VALUE;
+	if( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) )
+		return BS2B_KERNEL_AVX2;
 
-			sample[ 0 ] = ( ( uint16_t )sample_d[ 0 ] ) ^ 0x8000;
-			sample[ 1 ] = ( ( uint16_t )sample_d[ 1 ] ) ^ 0x8000;
+	if( __builtin_cpu_supports( "sse2" ) )
+		return BS2B_KERNEL_SSE2;
+	#elif defined( BS2B_HAVE_X86 ) && defined( _MSC_VER )
+	int      r1[ 4 ], r7[ 4 ] = { 0, 0, 0, 0 };
+	uint32_t xcr0 = 0;
 
-			#ifdef WORDS_BIGENDIAN
-			int16swap( sample );
-			int16swap( sample + 1 );
-			#endif
+	__cpuid( r1, 1 );
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u16le() */
+	/* __cpuidex() and _xgetbv() appeared in Visual C++ 2010,
+	 * AVX state is unknown to older compilers
+	 */
+	#if _MSC_VER >= 1600
+	__cpuidex( r7, 7, 0 );
 
-void bs2b_cross_feed_s8( t_bs2bdp bs2bdp, int8_t *sample, int n )
-{
-	double sample_d[ 2 ];
+	if( r1[ 2 ] & ( 1 << 27 ) ) /* OSXSAVE */
+		xcr0 = ( uint32_t )_xgetbv( 0 );
+	#endif /* _MSC_VER */
 
-	if( n > 0 )
-	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = ( double )sample[ 0 ];
-			sample_d[ 1 ] = ( double )sample[ 1 ];
+	if( ( xcr0 & 0xe6 ) == 0xe6 &&
+		( r7[ 1 ] & ( 1 << 16 ) ) && ( r7[ 1 ] & ( 1 << 17 ) ) &&
+		( r7[ 1 ] & ( 1 << 30 ) ) && ( r7[ 1 ] & ( 1 << 31 ) ) )
+		return BS2B_KERNEL_AVX512;
 
-			cross_feed_d( bs2bdp, sample_d );
+	if( ( xcr0 & 0x06 ) == 0x06 &&
+		( r7[ 1 ] & ( 1 << 5 ) ) && ( r1[ 2 ] & ( 1 << 12 ) ) )
+		return BS2B_KERNEL_AVX2;
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT8_VALUE ) sample_d[ 0 ] = MAX_INT8_VALUE;
-			if( sample_d[ 0 ] < MIN_INT8_VALUE ) sample_d[ 0 ] = MIN_INT8_VALUE;
-			if( sample_d[ 1 ] > MAX_INT8_VALUE ) sample_d[ 1 ] = MAX_INT8_VALUE;
-			if( sample_d[ 1 ] < MIN_INT8_VALUE ) sample_d[ 1 ] = MIN_INT8_VALUE;
+	if( r1[ 3 ] & ( 1 << 26 ) )
+		return BS2B_KERNEL_SSE2;
+	#endif /* BS2B_HAVE_X86 */
 
-			sample[ 0 ] = ( int8_t )sample_d[ 0 ];
-			sample[ 1 ] = ( int8_t )sample_d[ 1 ];
+	return BS2B_KERNEL_SCALAR;
+} /* cpu_kernel() */
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s8() */
+/* Overrides kernels of 'to' by non-NULL entries of 'k'. */
+static void merge_kernel( t_bs2b_kernel *to, t_bs2b_kernel const *k )
+{
+	int i;
+
+	to->id   = k->id;
+	to->name = k->name;
+
+	if( k->cross_feed_d ) to->cross_feed_d = k->cross_feed_d;
+	if( k->cross_feed_ahead_d )
+		to->cross_feed_ahead_d = k->cross_feed_ahead_d;
+	if( k->cross_feed_f ) to->cross_feed_f = k->cross_feed_f;
+	if( k->cross_feed_s16q ) to->cross_feed_s16q = k->cross_feed_s16q;
+	if( k->cross_feed_s32q ) to->cross_feed_s32q = k->cross_feed_s32q;
+	if( k->swap32 )       to->swap32       = k->swap32;
+	if( k->zip_d )        to->zip_d        = k->zip_d;
+	if( k->zip_f )        to->zip_f        = k->zip_f;
+	if( k->unzip_d )      to->unzip_d      = k->unzip_d;
+	if( k->unzip_f )      to->unzip_f      = k->unzip_f;
+	if( k->flush_fpu )    to->flush_fpu    = k->flush_fpu;
+	if( k->restore_fpu )  to->restore_fpu  = k->restore_fpu;
+	if( k->is_zero )      to->is_zero      = k->is_zero;
+	if( k->cross_feed_batch_f )
+		to->cross_feed_batch_f = k->cross_feed_batch_f;
+
+	for( i = 0; i < BS2B_FMT_COUNT; i++ )
+	{
+		if( k->decode[ i ] ) to->decode[ i ] = k->decode[ i ];
+		if( k->encode[ i ] ) to->encode[ i ] = k->encode[ i ];
+	}
+} /* merge_kernel() */
 
-void bs2b_cross_feed_u8( t_bs2bdp bs2bdp, uint8_t *sample, int n )
+/* Picks kernels by CPU features or by BS2B_KERNEL environment variable. */
+static void select_kernel( void )
 {
-	double sample_d[ 2 ];
+	static char const *names[] = { "scalar", "sse2", "avx2", "avx512" };
+	t_bs2b_kernel k;
+	char const *env;
+	int id, i;
 
-	if( n > 0 )
+	id = cpu_kernel();
+
+	if( NULL != ( env = getenv( "BS2B_KERNEL" ) ) )
 	{
-		while( n-- )
+		for( i = 0; i < ( int )( sizeof( names ) / sizeof( names[ 0 ] ) ); i++ )
 		{
-			sample_d[ 0 ] = ( double )( ( int8_t )( sample[ 0 ] ^ 0x80 ) );
-			sample_d[ 1 ] = ( double )( ( int8_t )( sample[ 1 ] ^ 0x80 ) );
-
-			cross_feed_d( bs2bdp, sample_d );
-
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT8_VALUE ) sample_d[ 0 ] = MAX_INT8_VALUE;
-			if( sample_d[ 0 ] < MIN_INT8_VALUE ) sample_d[ 0 ] = MIN_INT8_VALUE;
-			if( sample_d[ 1 ] > MAX_INT8_VALUE ) sample_d[ 1 ] = MAX_INT8_VALUE;
-			if( sample_d[ 1 ] < MIN_INT8_VALUE ) sample_d[ 1 ] = MIN_INT8_VALUE;
+			if( 0 == strcmp( env, names[ i ] ) )
+			{
+				if( i < id ) id = i;
+				break;
+			}
+		}
+	}
 
-			sample[ 0 ] = ( ( uint8_t )sample_d[ 0 ] ) ^ 0x80;
-			sample[ 1 ] = ( ( uint8_t )sample_d[ 1 ] ) ^ 0x80;
+	/* The shared table is never seen half merged */
+	k = kernel_scalar;
+
+	/* Kernels the compiler could not build leave the lower ones */
+	#ifdef BS2B_HAVE_X86
+	if( id >= BS2B_KERNEL_SSE2 )   merge_kernel( &k, &bs2b_kernel_sse2 );
+	#endif /* BS2B_HAVE_X86 */
+	#ifdef BS2B_HAVE_AVX2
+	if( id >= BS2B_KERNEL_AVX2 )   merge_kernel( &k, &bs2b_kernel_avx2 );
+	#endif /* BS2B_HAVE_AVX2 */
+	#ifdef BS2B_HAVE_AVX512
+	if( id >= BS2B_KERNEL_AVX512 ) merge_kernel( &k, &bs2b_kernel_avx512 );
+	#endif /* BS2B_HAVE_AVX512 */
+
+	kernel = k;
+	kernel_ready = 1;
+} /* select_kernel() */
+
+/* Kernels are selected once at load time, before any thread may call
+ * the library. Other compilers select them on the first bs2b_open()
+ * or bs2b_get_kernel(), which must not race with other threads.
+ */
+#if defined( __GNUC__ )
+static void __attribute__(( constructor )) load_kernel( void )
+{
+	select_kernel();
+} /* load_kernel() */
+#elif defined( _MSC_VER )
+static void __cdecl load_kernel( void )
+{
+	select_kernel();
+} /* load_kernel() */
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u8() */
+/* An entry of the CRT initializer table, the linker keeps it
+ * by the symbol
+ */
+#pragma section( ".CRT$XCU", read )
+__declspec( allocate( ".CRT$XCU" ) )
+void ( __cdecl *bs2b_load_kernel )( void ) = load_kernel;
+
+#ifdef _M_IX86
+#pragma comment( linker, "/include:_bs2b_load_kernel" )
+#else
+#pragma comment( linker, "/include:bs2b_load_kernel" )
+#endif /* _M_IX86 */
+#endif /* __GNUC__ */
+
+/* Kernels take int counts of stereo samples */
+#define MAX_KERNEL_FRAMES ( INT_MAX / 2 )
+
+/* Buffer values below are snapped to zero, BS2B_FLAG_DENORMAL_SAFE.
+ * That is far under a LSB of any format and above denormals of floats.
+ */
+#define SNAP_LEVEL 1e-30
 
-void bs2b_cross_feed_s24( t_bs2bdp bs2bdp, bs2b_int24_t *sample, int n )
+/* Snaps fading double and float buffers to zero before they turn
+ * to denormals, BS2B_FLAG_DENORMAL_SAFE
+ */
+static void snap_state( t_bs2bdp bs2bdp )
 {
-	double sample_d[ 2 ];
+	int i;
 
-	if( n > 0 )
+	for( i = 0; i < 2; i++ )
 	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = int242double( sample );
-			sample_d[ 1 ] = int242double( sample + 1 );
-
-			cross_feed_d( bs2bdp, sample_d );
+		if( fabs( bs2bdp->lfs.asis[ i ] ) < SNAP_LEVEL )
+			bs2bdp->lfs.asis[ i ] = 0.0;
+		if( fabs( bs2bdp->lfs.lo[ i ] ) < SNAP_LEVEL )
+			bs2bdp->lfs.lo[ i ] = 0.0;
+		if( fabs( bs2bdp->lfs.hi[ i ] ) < SNAP_LEVEL )
+			bs2bdp->lfs.hi[ i ] = 0.0;
+
+		if( fabs( bs2bdp->lfsf.asis[ i ] ) < SNAP_LEVEL )
+			bs2bdp->lfsf.asis[ i ] = 0.0f;
+		if( fabs( bs2bdp->lfsf.lo[ i ] ) < SNAP_LEVEL )
+			bs2bdp->lfsf.lo[ i ] = 0.0f;
+		if( fabs( bs2bdp->lfsf.hi[ i ] ) < SNAP_LEVEL )
+			bs2bdp->lfsf.hi[ i ] = 0.0f;
+	}
+} /* snap_state() */
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT24_VALUE ) sample_d[ 0 ] = MAX_INT24_VALUE;
-			if( sample_d[ 0 ] < MIN_INT24_VALUE ) sample_d[ 0 ] = MIN_INT24_VALUE;
-			if( sample_d[ 1 ] > MAX_INT24_VALUE ) sample_d[ 1 ] = MAX_INT24_VALUE;
-			if( sample_d[ 1 ] < MIN_INT24_VALUE ) sample_d[ 1 ] = MIN_INT24_VALUE;
+/* Return 1 if bs2b_post_level() was ever called */
+#define POSTED( bs2bdp ) \
+	bs2b_atomic_load( &( ( t_bs2b_post * )( bs2bdp )->post )->posted )
 
-			double2int24( sample_d[ 0 ], sample );
-			double2int24( sample_d[ 1 ], sample + 1 );
+/* Number of stereo samples per kernel call */
+static int kernel_frames( t_bs2bdp bs2bdp, size_t n )
+{
+	/* A buffer is snapped, silence is checked and posted coefficients
+	 * are taken at least once per block
+	 */
+	size_t max = ( bs2bdp->flags &
+		( BS2B_FLAG_DENORMAL_SAFE | BS2B_FLAG_SKIP_SILENCE ) ) ||
+		POSTED( bs2bdp ) ? BS2B_BLOCK : MAX_KERNEL_FRAMES;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s24() */
+	return n < max ? ( int )n : ( int )max;
+} /* kernel_frames() */
 
-void bs2b_cross_feed_u24( t_bs2bdp bs2bdp, bs2b_uint24_t *sample, int n )
+/* Run the double/single precision and fixed-point kernels
+ * with posted coefficients and snap the buffer
+ */
+static void kernel_d( t_bs2bdp bs2bdp, double const *in, double *out, int n )
 {
-	double sample_d[ 2 ];
+	if( POSTED( bs2bdp ) ) take_post( bs2bdp );
 
-	if( n > 0 )
-	{
-		while( n-- )
-		{
-			sample_d[ 0 ] = uint242double( sample )     - MAX_INT24_VALUE - 1.0;
-			sample_d[ 1 ] = uint242double( sample + 1 ) - MAX_INT24_VALUE - 1.0;
+	if( bs2bdp->flags & BS2B_FLAG_LOOKAHEAD )
+		kernel.cross_feed_ahead_d( bs2bdp, in, out, n );
+	else
+		kernel.cross_feed_d( bs2bdp, in, out, n );
 
-			cross_feed_d( bs2bdp, sample_d );
+	if( bs2bdp->flags & BS2B_FLAG_DENORMAL_SAFE )
+		snap_state( bs2bdp );
+} /* kernel_d() */
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT24_VALUE ) sample_d[ 0 ] = MAX_INT24_VALUE;
-			if( sample_d[ 0 ] < MIN_INT24_VALUE ) sample_d[ 0 ] = MIN_INT24_VALUE;
-			if( sample_d[ 1 ] > MAX_INT24_VALUE ) sample_d[ 1 ] = MAX_INT24_VALUE;
-			if( sample_d[ 1 ] < MIN_INT24_VALUE ) sample_d[ 1 ] = MIN_INT24_VALUE;
+static void kernel_f( t_bs2bdp bs2bdp, float const *in, float *out, int n )
+{
+	if( POSTED( bs2bdp ) ) take_post( bs2bdp );
 
-			double2uint24( sample_d[ 0 ] + MAX_INT24_VALUE + 1.0 , sample );
-			double2uint24( sample_d[ 1 ] + MAX_INT24_VALUE + 1.0 , sample + 1 );
+	kernel.cross_feed_f( bs2bdp, in, out, n );
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u24() */
+	if( bs2bdp->flags & BS2B_FLAG_DENORMAL_SAFE )
+		snap_state( bs2bdp );
+} /* kernel_f() */
 
-void bs2b_cross_feed_s24be( t_bs2bdp bs2bdp, bs2b_int24_t *sample, int n )
+static void kernel_q( t_bs2bdp bs2bdp, void const *in, void *out, int n,
+	int fmt )
+{
+	if( POSTED( bs2bdp ) ) take_post( bs2bdp );
+
+	if( BS2B_FMT_S16 == fmt )
+		kernel.cross_feed_s16q( bs2bdp,
+			( int16_t const * )in, ( int16_t * )out, n );
+	else
+		kernel.cross_feed_s32q( bs2bdp,
+			( int32_t const * )in, ( int32_t * )out, n );
+} /* kernel_q() */
+
+/* Return 1 if 'n' samples of 'size' bytes from 'in' are zeros and
+ * the buffer has faded under the silence level, 'scale' is a full scale
+ * of the double precision buffer. Then the buffer is cleared, 'out'
+ * is zeroed and samples are counted as skipped, BS2B_FLAG_SKIP_SILENCE
+ */
+static int skip_silence( t_bs2bdp bs2bdp, void const *in, void *out,
+	int n, size_t size, double scale )
 {
-	double sample_d[ 2 ];
+	double level  = bs2bdp->silence;
+	double qlevel = level * 1073741824.0;
+	int    i;
 
-	if( n > 0 )
+	if( !( bs2bdp->flags & BS2B_FLAG_SKIP_SILENCE ) ) return 0;
+
+	for( i = 0; i < 2; i++ )
 	{
-		while( n-- )
-		{
-			#ifndef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+		if( fabs( bs2bdp->lfs.asis[ i ] ) >= level * scale ||
+			fabs( bs2bdp->lfs.lo[ i ] ) >= level * scale ||
+			fabs( bs2bdp->lfs.hi[ i ] ) >= level * scale )
+			return 0;
 
-			sample_d[ 0 ] = int242double( sample );
-			sample_d[ 1 ] = int242double( sample + 1 );
+		if( fabs( bs2bdp->lfsf.asis[ i ] ) >= level ||
+			fabs( bs2bdp->lfsf.lo[ i ] ) >= level ||
+			fabs( bs2bdp->lfsf.hi[ i ] ) >= level )
+			return 0;
 
-			cross_feed_d( bs2bdp, sample_d );
+		/* Q30 buffer is scaled to 2^30 for both 16 and 32 bit formats */
+		if( fabs( ( double )bs2bdp->lfsq.asis[ i ] ) >= qlevel ||
+			fabs( ( double )bs2bdp->lfsq.lo[ i ] ) >= qlevel ||
+			fabs( ( double )bs2bdp->lfsq.hi[ i ] ) >= qlevel )
+			return 0;
+	}
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT24_VALUE ) sample_d[ 0 ] = MAX_INT24_VALUE;
-			if( sample_d[ 0 ] < MIN_INT24_VALUE ) sample_d[ 0 ] = MIN_INT24_VALUE;
-			if( sample_d[ 1 ] > MAX_INT24_VALUE ) sample_d[ 1 ] = MAX_INT24_VALUE;
-			if( sample_d[ 1 ] < MIN_INT24_VALUE ) sample_d[ 1 ] = MIN_INT24_VALUE;
+	if( !kernel.is_zero( in, ( int )( n * size ) ) ) return 0;
 
-			double2int24( sample_d[ 0 ], sample );
-			double2int24( sample_d[ 1 ], sample + 1 );
+	bs2b_clear( bs2bdp );
 
-			#ifndef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+	if( out != in )
+		memset( out, 0, n * size );
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s24be() */
+	bs2bdp->skipped += n;
 
-void bs2b_cross_feed_u24be( t_bs2bdp bs2bdp, bs2b_uint24_t *sample, int n )
+	return 1;
+} /* skip_silence() */
+
+/* Crossfeeds 'n' stereo samples of floats from 'in' to 'out'
+ * by the single precision engine. Byte swapped floats if 'swap'.
+ */
+static void cross_feed_single( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n, int swap )
 {
-	double sample_d[ 2 ];
+	float block[ BS2B_BLOCK * 2 ];
+	int   m;
 
-	if( n > 0 )
+	for( ; n > 0; n -= m, in += m * 2, out += m * 2 )
 	{
-		while( n-- )
+		if( swap )
+			m = n < BS2B_BLOCK ? ( int )n : BS2B_BLOCK;
+		else
+			m = kernel_frames( bs2bdp, n );
+
+		if( skip_silence( bs2bdp, in, out, m, sizeof( float ) * 2, 1.0 ) )
+			continue;
+
+		if( swap )
 		{
-			#ifndef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+			kernel.swap32( in, block, m * 2 );
+			kernel_f( bs2bdp, block, block, m );
+			kernel.swap32( block, out, m * 2 );
+		}
+		else
+			kernel_f( bs2bdp, in, out, m );
+	} /* for */
+} /* cross_feed_single() */
+
+/* Crossfeeds 'n' stereo samples of native endian 16 ( BS2B_FMT_S16 )
+ * or 32 ( BS2B_FMT_S32 ) bit integers from 'in' to 'out'
+ * by the fixed-point engine.
+ */
+static void cross_feed_fixed( t_bs2bdp bs2bdp, void const *in, void *out,
+	size_t n, int fmt )
+{
+	size_t size = fmt_size[ fmt ] * 2;
+	int    m;
+
+	for( ; n > 0; n -= m )
+	{
+		m = kernel_frames( bs2bdp, n );
 
-			sample_d[ 0 ] = uint242double( sample )     - MAX_INT24_VALUE - 1.0;
-			sample_d[ 1 ] = uint242double( sample + 1 ) - MAX_INT24_VALUE - 1.0;
+		if( !skip_silence( bs2bdp, in, out, m, size, fmt_scale[ fmt ] ) )
+			kernel_q( bs2bdp, in, out, m, fmt );
 
-			cross_feed_d( bs2bdp, sample_d );
+		in  = ( char const * )in + m * size;
+		out = ( char * )out + m * size;
+	} /* for */
+} /* cross_feed_fixed() */
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT24_VALUE ) sample_d[ 0 ] = MAX_INT24_VALUE;
-			if( sample_d[ 0 ] < MIN_INT24_VALUE ) sample_d[ 0 ] = MIN_INT24_VALUE;
-			if( sample_d[ 1 ] > MAX_INT24_VALUE ) sample_d[ 1 ] = MAX_INT24_VALUE;
-			if( sample_d[ 1 ] < MIN_INT24_VALUE ) sample_d[ 1 ] = MIN_INT24_VALUE;
+/* Crossfeeds 'n' stereo samples of 'fmt' format from 'in' to 'out'
+ * block by block. 'in' and 'out' are the same or not overlapped buffers.
+ */
+static void cross_feed_to( t_bs2bdp bs2bdp, void const *in, void *out,
+	size_t n, int fmt )
+{
+	double       block[ BS2B_BLOCK * 2 ];
+	size_t       size;
+	unsigned int mode = 0;
+	int          m;
 
-			double2uint24( sample_d[ 0 ] + MAX_INT24_VALUE + 1.0 , sample );
-			double2uint24( sample_d[ 1 ] + MAX_INT24_VALUE + 1.0 , sample + 1 );
+	if( bs2bdp->lazy ) init( bs2bdp );
 
-			#ifndef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+	if( bs2bdp->flags & BS2B_FLAG_DENORMAL_SAFE )
+		mode = kernel.flush_fpu();
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u24be() */
+	if( BS2B_FMT_D == fmt )
+	{
+		for( ; n > 0; n -= m )
+		{
+			m = kernel_frames( bs2bdp, n );
 
-void bs2b_cross_feed_s24le( t_bs2bdp bs2bdp, bs2b_int24_t *sample, int n )
-{
-	double sample_d[ 2 ];
+			if( !skip_silence( bs2bdp, in, out, m, sizeof( double ) * 2, 1.0 ) )
+				kernel_d( bs2bdp, ( double const * )in, ( double * )out, m );
+
+			in  = ( double const * )in + m * 2;
+			out = ( double * )out + m * 2;
+		} /* for */
+	}
+	else if( ( bs2bdp->flags & BS2B_FLAG_FLOAT ) &&
+		( BS2B_FMT_F == fmt || BS2B_FMT_FX == fmt ) )
+	{
+		cross_feed_single( bs2bdp, ( float const * )in, ( float * )out, n,
+			BS2B_FMT_FX == fmt );
+	}
+	else if( ( bs2bdp->flags & BS2B_FLAG_FIXED ) &&
+		( BS2B_FMT_S16 == fmt || BS2B_FMT_S32 == fmt ) )
+	{
+		cross_feed_fixed( bs2bdp, in, out, n, fmt );
+	}
+	else
+	{
+		size = fmt_size[ fmt ] * 2;
+
+		for( ; n > 0; n -= m )
+		{
+			m = n < BS2B_BLOCK ? ( int )n : BS2B_BLOCK;
+
+			if( !fmt_zero_silent[ fmt ] ||
+				!skip_silence( bs2bdp, in, out, m, size, fmt_scale[ fmt ] ) )
+			{
+				kernel.decode[ fmt ]( in, block, m * 2 );
+				kernel_d( bs2bdp, block, block, m );
+				kernel.encode[ fmt ]( block, out, m * 2 );
+			}
+
+			in  = ( char const * )in + m * size;
+			out = ( char * )out + m * size;
+		} /* for */
+	}
+
+	if( bs2bdp->flags & BS2B_FLAG_DENORMAL_SAFE )
+		kernel.restore_fpu( mode );
+} /* cross_feed_to() */
 
+/* Crossfeeds 'n' stereo samples of 'fmt' format in place. */
+static void cross_feed( t_bs2bdp bs2bdp, void *sample, int n, int fmt )
+{
 	if( n > 0 )
+		cross_feed_to( bs2bdp, sample, sample, ( size_t )n, fmt );
+} /* cross_feed() */
+
+/* Crossfeeds 'n' stereo samples of planar doubles ( BS2B_FMT_D )
+ * or floats ( BS2B_FMT_F ) from 'in_left', 'in_right' to 'out_left',
+ * 'out_right' through an interleaved block.
+ */
+static void cross_feed_planar( t_bs2bdp bs2bdp,
+	void const *in_left, void const *in_right,
+	void *out_left, void *out_right, size_t n, int fmt )
+{
+	double       block[ BS2B_BLOCK * 2 ];
+	float        fblock[ BS2B_BLOCK * 2 ];
+	size_t       size = BS2B_FMT_D == fmt ? sizeof( double ) : sizeof( float );
+	unsigned int mode = 0;
+	int          m;
+
+	if( bs2bdp->lazy ) init( bs2bdp );
+
+	if( bs2bdp->flags & BS2B_FLAG_DENORMAL_SAFE )
+		mode = kernel.flush_fpu();
+
+	for( ; n > 0; n -= m )
 	{
-		while( n-- )
+		m = n < BS2B_BLOCK ? ( int )n : BS2B_BLOCK;
+
+		if( ( bs2bdp->flags & BS2B_FLAG_SKIP_SILENCE ) &&
+			kernel.is_zero( in_right, ( int )( m * size ) ) &&
+			skip_silence( bs2bdp, in_left, out_left, m, size, 1.0 ) )
+		{
+			if( out_right != in_right )
+				memset( out_right, 0, m * size );
+		}
+		else if( BS2B_FMT_D == fmt )
 		{
-			#ifdef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+			kernel.zip_d( ( double const * )in_left,
+				( double const * )in_right, block, m );
+			kernel_d( bs2bdp, block, block, m );
+			kernel.unzip_d( block,
+				( double * )out_left, ( double * )out_right, m );
+		}
+		else
+		{
+			kernel.zip_f( ( float const * )in_left,
+				( float const * )in_right, fblock, m );
+
+			if( bs2bdp->flags & BS2B_FLAG_FLOAT )
+				kernel_f( bs2bdp, fblock, fblock, m );
+			else
+			{
+				kernel.decode[ BS2B_FMT_F ]( fblock, block, m * 2 );
+				kernel_d( bs2bdp, block, block, m );
+				kernel.encode[ BS2B_FMT_F ]( block, fblock, m * 2 );
+			}
+
+			kernel.unzip_f( fblock,
+				( float * )out_left, ( float * )out_right, m );
+		}
+
+		in_left   = ( char const * )in_left + m * size;
+		in_right  = ( char const * )in_right + m * size;
+		out_left  = ( char * )out_left + m * size;
+		out_right = ( char * )out_right + m * size;
+	} /* for */
+
+	if( bs2bdp->flags & BS2B_FLAG_DENORMAL_SAFE )
+		kernel.restore_fpu( mode );
+} /* cross_feed_planar() */
+
+/* Crossfeeds 'n' frames of 'channels' interleaved doubles ( BS2B_FMT_D )
+ * or floats ( BS2B_FMT_F ) in place. Channels pairs[ k * 2 ] and
+ * pairs[ k * 2 + 1 ] are crossfed by bs2bdp[ k ], 'k' < 'count'.
+ * Frames are processed block by block, each pair is gathered
+ * into an interleaved block and scattered back.
+ */
+static void cross_feed_pairs( t_bs2bdp const *bs2bdp, int const *pairs,
+	int count, void *sample, size_t n, int channels, int fmt )
+{
+	double       block[ BS2B_BLOCK * 2 ];
+	float        fblock[ BS2B_BLOCK * 2 ];
+	double       *d;
+	float        *f;
+	uint32_t     flags = 0;
+	unsigned int mode = 0;
+	int          i, k, l, r, m;
+
+	for( k = 0; k < count; k++ )
+	{
+		if( pairs[ k * 2 ] < 0 || pairs[ k * 2 ] >= channels ||
+			pairs[ k * 2 + 1 ] < 0 || pairs[ k * 2 + 1 ] >= channels )
+			return;
+	}
 
-			sample_d[ 0 ] = int242double( sample );
-			sample_d[ 1 ] = int242double( sample + 1 );
+	for( k = 0; k < count; k++ )
+	{
+		if( bs2bdp[ k ]->lazy ) init( bs2bdp[ k ] );
 
-			cross_feed_d( bs2bdp, sample_d );
+		flags |= bs2bdp[ k ]->flags;
+	}
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT24_VALUE ) sample_d[ 0 ] = MAX_INT24_VALUE;
-			if( sample_d[ 0 ] < MIN_INT24_VALUE ) sample_d[ 0 ] = MIN_INT24_VALUE;
-			if( sample_d[ 1 ] > MAX_INT24_VALUE ) sample_d[ 1 ] = MAX_INT24_VALUE;
-			if( sample_d[ 1 ] < MIN_INT24_VALUE ) sample_d[ 1 ] = MIN_INT24_VALUE;
+	if( flags & BS2B_FLAG_DENORMAL_SAFE )
+		mode = kernel.flush_fpu();
 
-			double2int24( sample_d[ 0 ], sample );
-			double2int24( sample_d[ 1 ], sample + 1 );
+	for( ; n > 0; n -= m )
+	{
+		m = n < BS2B_BLOCK ? ( int )n : BS2B_BLOCK;
 
-			#ifdef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+		for( k = 0; k < count; k++ )
+		{
+			l = pairs[ k * 2 ];
+			r = pairs[ k * 2 + 1 ];
+
+			if( BS2B_FMT_D == fmt )
+			{
+				d = ( double * )sample;
+
+				for( i = 0; i < m; i++, d += channels )
+				{
+					block[ i * 2 ]     = d[ l ];
+					block[ i * 2 + 1 ] = d[ r ];
+				}
+
+				/* Zeros need not be scattered back */
+				if( skip_silence( bs2bdp[ k ], block, block, m,
+					sizeof( double ) * 2, 1.0 ) )
+					continue;
+
+				kernel_d( bs2bdp[ k ], block, block, m );
+
+				d = ( double * )sample;
+
+				for( i = 0; i < m; i++, d += channels )
+				{
+					d[ l ] = block[ i * 2 ];
+					d[ r ] = block[ i * 2 + 1 ];
+				}
+			}
+			else
+			{
+				f = ( float * )sample;
+
+				for( i = 0; i < m; i++, f += channels )
+				{
+					fblock[ i * 2 ]     = f[ l ];
+					fblock[ i * 2 + 1 ] = f[ r ];
+				}
+
+				if( skip_silence( bs2bdp[ k ], fblock, fblock, m,
+					sizeof( float ) * 2, 1.0 ) )
+					continue;
+
+				if( bs2bdp[ k ]->flags & BS2B_FLAG_FLOAT )
+					kernel_f( bs2bdp[ k ], fblock, fblock, m );
+				else
+				{
+					kernel.decode[ BS2B_FMT_F ]( fblock, block, m * 2 );
+					kernel_d( bs2bdp[ k ], block, block, m );
+					kernel.encode[ BS2B_FMT_F ]( block, fblock, m * 2 );
+				}
+
+				f = ( float * )sample;
+
+				for( i = 0; i < m; i++, f += channels )
+				{
+					f[ l ] = fblock[ i * 2 ];
+					f[ r ] = fblock[ i * 2 + 1 ];
+				}
+			}
+		} /* for */
+
+		if( BS2B_FMT_D == fmt )
+			sample = ( double * )sample + ( size_t )m * channels;
+		else
+			sample = ( float * )sample + ( size_t )m * channels;
+	} /* for */
+
+	if( flags & BS2B_FLAG_DENORMAL_SAFE )
+		kernel.restore_fpu( mode );
+} /* cross_feed_pairs() */
+
+/* Big/little endian formats */
+#ifdef WORDS_BIGENDIAN
+#define FMT_BE( fmt ) fmt
+#define FMT_LE( fmt ) fmt##X
+#else
+#define FMT_BE( fmt ) fmt##X
+#define FMT_LE( fmt ) fmt
+#endif /* WORDS_BIGENDIAN */
+
+
+/* Crossfeeds 'n' stereo samples of doubles ( BS2B_FMT_D ) or floats
+ * ( BS2B_FMT_F ) from 'in' to 'out' setting levels of 'count' sorted
+ * events at their frames. Coefficients of events are set by
+ * init_nolock(), so the audio thread never waits for coef_lock.
+ */
+static void cross_feed_events( t_bs2bdp bs2bdp, void const *in, void *out,
+	size_t n, int fmt, t_bs2b_event const *event, size_t count )
+{
+	size_t size = ( BS2B_FMT_D == fmt ? sizeof( double ) : sizeof( float ) ) * 2;
+	size_t done = 0;
+	size_t next;
+	size_t k;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_s24le() */
+	if( NULL == bs2bdp ) return;
 
-void bs2b_cross_feed_u24le( t_bs2bdp bs2bdp, bs2b_uint24_t *sample, int n )
+	if( bs2bdp->lazy ) init_nolock( bs2bdp );
+
+	for( k = 0; k <= count; k++ )
+	{
+		next = k < count && event[ k ].frame < n ? event[ k ].frame : n;
+
+		if( next > done )
+		{
+			cross_feed_to( bs2bdp, ( char const * )in + done * size,
+				( char * )out + done * size, next - done, fmt );
+			done = next;
+		}
+
+		if( k == count ) break;
+
+		/* Only the last of events at the same frame matters */
+		if( k + 1 < count && event[ k + 1 ].frame <= event[ k ].frame )
+			continue;
+
+		if( event[ k ].level != bs2bdp->level )
+		{
+			bs2bdp->level = event[ k ].level;
+			init_nolock( bs2bdp );
+			stop_ramp( bs2bdp );
+		}
+	} /* for */
+} /* cross_feed_events() */
+
+/* Crossfeeds 'n' stereo samples of BS2B_BATCH_LANES streams of a batch
+ * from 'first' on. Lanes past the last stream have zero coefficients
+ * and run on zeros.
+ */
+static void cross_feed_batch( t_bs2b_batchp batch, float * const *sample,
+	size_t first, size_t n )
 {
-	double sample_d[ 2 ];
+	float  zero[ BS2B_BLOCK * 2 ];
+	float  *x[ BS2B_BATCH_LANES ];
+	size_t lanes = batch->count - first;
+	size_t done, k;
+	int    m;
 
-	if( n > 0 )
+	if( lanes > BS2B_BATCH_LANES ) lanes = BS2B_BATCH_LANES;
+
+	memset( zero, 0, sizeof( zero ) );
+
+	for( done = 0; done < n; done += m )
 	{
-		while( n-- )
+		m = n - done < BS2B_BLOCK ? ( int )( n - done ) : BS2B_BLOCK;
+
+		for( k = 0; k < BS2B_BATCH_LANES; k++ )
+			x[ k ] = k < lanes ? sample[ first + k ] + done * 2 : zero;
+
+		kernel.cross_feed_batch_f( batch, first, x, m );
+	}
+} /* cross_feed_batch() */
+
+/* Shortest chunk of bs2b_cross_feed_parallel_*(), a thread is not
+ * worth less
+ */
+#define PARALLEL_MIN_FRAMES 65536
+
+/* A part of a buffer crossfed by one thread */
+typedef struct
+{
+	t_bs2bd      bs2bd;  /* A copy of an instance, zero state but first */
+	double const *in;
+	double       *out;
+	size_t       n;
+	/* The exact state before the part */
+	struct { double asis[ 2 ], lo[ 2 ], hi[ 2 ]; } from;
+	bs2b_thread  thread;
+	int          started;
+} t_bs2b_chunk;
+
+/* The first pass: a response to input of a part from its state */
+static BS2B_THREAD_PROC( chunk_cross_feed, arg )
+{
+	t_bs2b_chunk *chunk = ( t_bs2b_chunk * )arg;
+
+	cross_feed_to( &chunk->bs2bd, chunk->in, chunk->out, chunk->n,
+		BS2B_FMT_D );
+
+	return BS2B_THREAD_RETURN;
+} /* chunk_cross_feed() */
+
+/* The second pass: filters are linear, so a response to the exact state
+ * before a part over zero input is added to the first one. It decays
+ * by poles and is added until it is under SNAP_LEVEL.
+ */
+static BS2B_THREAD_PROC( chunk_add_state, arg )
+{
+	t_bs2b_chunk *chunk = ( t_bs2b_chunk * )arg;
+	t_bs2bdp     bs2bdp = &chunk->bs2bd;
+	double       *out = chunk->out;
+	double       asis[ 2 ], lo[ 2 ], hi[ 2 ];
+	size_t       k;
+	int          i;
+
+	for( i = 0; i < 2; i++ )
+	{
+		asis[ i ] = chunk->from.asis[ i ];
+		lo[ i ]   = chunk->from.lo[ i ];
+		hi[ i ]   = chunk->from.hi[ i ];
+	}
+
+	for( k = 0; k < chunk->n; k++ )
+	{
+		for( i = 0; i < 2; i++ )
 		{
-			#ifdef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+			lo[ i ]   = lo_filter( 0.0, lo[ i ] );
+			hi[ i ]   = hi_filter( 0.0, asis[ i ], hi[ i ] );
+			asis[ i ] = 0.0;
+		}
+
+		out[ 0 ] += ( hi[ 0 ] + lo[ 1 ] ) * bs2bdp->gain;
+		out[ 1 ] += ( hi[ 1 ] + lo[ 0 ] ) * bs2bdp->gain;
+		out += 2;
+
+		if( fabs( lo[ 0 ] ) < SNAP_LEVEL && fabs( lo[ 1 ] ) < SNAP_LEVEL &&
+			fabs( hi[ 0 ] ) < SNAP_LEVEL && fabs( hi[ 1 ] ) < SNAP_LEVEL )
+			break;
+	} /* for */
+
+	return BS2B_THREAD_RETURN;
+} /* chunk_add_state() */
+
+/* Runs 'proc' on 'count' chunks, on threads but the first one, which
+ * is run by the calling thread as well as chunks whose threads
+ * failed to start.
+ */
+static void run_chunks( t_bs2b_chunk *chunk, int count,
+	bs2b_thread_proc proc )
+{
+	int k;
 
-			sample_d[ 0 ] = uint242double( sample )     - MAX_INT24_VALUE - 1.0;
-			sample_d[ 1 ] = uint242double( sample + 1 ) - MAX_INT24_VALUE - 1.0;
+	for( k = 1; k < count; k++ )
+		chunk[ k ].started =
+			0 == bs2b_thread_create( &chunk[ k ].thread, proc, &chunk[ k ] );
 
-			cross_feed_d( bs2bdp, sample_d );
+	proc( &chunk[ 0 ] );
 
-			/* Clipping of overloaded samples */
-			if( sample_d[ 0 ] > MAX_INT24_VALUE ) sample_d[ 0 ] = MAX_INT24_VALUE;
-			if( sample_d[ 0 ] < MIN_INT24_VALUE ) sample_d[ 0 ] = MIN_INT24_VALUE;
-			if( sample_d[ 1 ] > MAX_INT24_VALUE ) sample_d[ 1 ] = MAX_INT24_VALUE;
-			if( sample_d[ 1 ] < MIN_INT24_VALUE ) sample_d[ 1 ] = MIN_INT24_VALUE;
+	for( k = 1; k < count; k++ )
+	{
+		if( chunk[ k ].started )
+			bs2b_thread_join( chunk[ k ].thread );
+		else
+			proc( &chunk[ k ] );
+	}
+} /* run_chunks() */
 
-			double2uint24( sample_d[ 0 ] + MAX_INT24_VALUE + 1.0 , sample );
-			double2uint24( sample_d[ 1 ] + MAX_INT24_VALUE + 1.0 , sample + 1 );
+/* Crossfeeds 'n' stereo samples of doubles from 'in' to 'out' by parts
+ * on up to 'threads' threads in two passes.
+ */
+static void cross_feed_parallel( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n, int threads )
+{
+	t_bs2b_post  idle;
+	t_bs2b_chunk *chunk;
+	double       pow_lo, pow_hi;
+	size_t       len;
+	int          count, k, i;
 
-			#ifdef WORDS_BIGENDIAN
-			int24swap( ( bs2b_uint24_t * )sample );
-			int24swap( ( bs2b_uint24_t * )( sample + 1 ) );
-			#endif
+	if( NULL == bs2bdp || 0 == n ) return;
 
-			sample += 2;
-		} /* while */
-	} /* if */
-} /* bs2b_cross_feed_u24le() */
+	if( bs2bdp->lazy ) init( bs2bdp );
+
+	/* Coefficients are constant over the buffer */
+	if( POSTED( bs2bdp ) ) finish_post( bs2bdp );
+
+	if( threads <= 0 ) threads = bs2b_cpu_count();
+	count = n / PARALLEL_MIN_FRAMES < ( size_t )threads ?
+		( int )( n / PARALLEL_MIN_FRAMES ) : threads;
+
+	chunk = count > 1 ?
+		( t_bs2b_chunk * )malloc( sizeof( t_bs2b_chunk ) * count ) : NULL;
+
+	if( NULL == chunk )
+	{
+		cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_D );
+		return;
+	}
+
+	/* Copies of the instance do not take posts and skip no silence,
+	 * which would not be linear
+	 */
+	memset( &idle, 0, sizeof( idle ) );
+
+	for( k = 0; k < count; k++ )
+	{
+		len = n / count + ( ( size_t )k < n % count );
+
+		chunk[ k ].bs2bd = *bs2bdp;
+		chunk[ k ].bs2bd.flags &=
+			BS2B_FLAG_DENORMAL_SAFE | BS2B_FLAG_LOOKAHEAD;
+		chunk[ k ].bs2bd.post = &idle;
+		if( k > 0 )
+			memset( &chunk[ k ].bs2bd.lfs, 0, sizeof( bs2bdp->lfs ) );
+
+		chunk[ k ].in  = in;
+		chunk[ k ].out = out;
+		chunk[ k ].n   = len;
+
+		in  += len * 2;
+		out += len * 2;
+	} /* for */
+
+	run_chunks( chunk, count, chunk_cross_feed );
+
+	/* Exact states before parts, ends of zero state responses plus
+	 * decayed states before them
+	 */
+	for( k = 1; k < count; k++ )
+	{
+		pow_lo = pow( bs2bdp->b1_lo, ( double )chunk[ k ].n );
+		pow_hi = pow( bs2bdp->b1_hi, ( double )( chunk[ k ].n - 1 ) );
+
+		for( i = 0; i < 2; i++ )
+		{
+			chunk[ k ].from.asis[ i ] = chunk[ k - 1 ].bs2bd.lfs.asis[ i ];
+			chunk[ k ].from.lo[ i ]   = chunk[ k - 1 ].bs2bd.lfs.lo[ i ];
+			chunk[ k ].from.hi[ i ]   = chunk[ k - 1 ].bs2bd.lfs.hi[ i ];
+
+			chunk[ k ].bs2bd.lfs.lo[ i ] += pow_lo * chunk[ k ].from.lo[ i ];
+			chunk[ k ].bs2bd.lfs.hi[ i ] += pow_hi *
+				hi_filter( 0.0, chunk[ k ].from.asis[ i ],
+					chunk[ k ].from.hi[ i ] );
+		}
+	} /* for */
+
+	run_chunks( chunk + 1, count - 1, chunk_add_state );
+
+	memcpy( &bs2bdp->lfs, &chunk[ count - 1 ].bs2bd.lfs,
+		sizeof( bs2bdp->lfs ) );
+
+	free( chunk );
+} /* cross_feed_parallel() */
+
+/* Exported functions.
+ * See descriptions in "bs2b.h"
+ */
+
+t_bs2bdp bs2b_open( void )
+{
+	t_bs2bdp bs2bdp = NULL;
+
+	if( !kernel_ready ) select_kernel();
+
+	/* Posted coefficients follow the data */
+	if( NULL != ( bs2bdp = malloc( sizeof( t_bs2bd ) + sizeof( t_bs2b_post ) ) ) )
+	{
+		memset( bs2bdp, 0, sizeof( t_bs2bd ) + sizeof( t_bs2b_post ) );
+		bs2bdp->post = bs2bdp + 1;
+		( ( t_bs2b_post * )bs2bdp->post )->back   = 1;
+		( ( t_bs2b_post * )bs2bdp->post )->middle = 2;
+		bs2bdp->silence = BS2B_DEFAULT_SILENCE;
+		bs2b_set_srate( bs2bdp, BS2B_DEFAULT_SRATE );
+	}
+
+	return bs2bdp;
+} /* bs2b_open() */
+
+void bs2b_close( t_bs2bdp bs2bdp )
+{
+	free( bs2bdp );
+} /* bs2b_close() */
+
+void bs2b_set_level( t_bs2bdp bs2bdp, uint32_t level )
+{
+	if( NULL == bs2bdp ) return;
+
+	if( level == bs2bdp->level ) return;
+
+	bs2bdp->level = level;
+	init( bs2bdp );
+	stop_ramp( bs2bdp );
+} /* bs2b_set_level() */
+
+uint32_t bs2b_get_level( t_bs2bdp bs2bdp )
+{
+	return bs2bdp->level;
+} /* bs2b_get_level() */
+
+void bs2b_post_level( t_bs2bdp bs2bdp, uint32_t level )
+{
+	t_bs2b_post *post;
+	t_bs2bd     *back;
+
+	if( NULL == bs2bdp ) return;
+
+	post = ( t_bs2b_post * )bs2bdp->post;
+	back = &post->set[ post->back ];
+
+	back->srate = bs2bdp->srate;
+	back->level = level;
+	init( back );
+
+	post->back = bs2b_atomic_exchange( &post->middle,
+		post->back | POST_FRESH ) & 3;
+	bs2b_atomic_store( &post->posted, 1 );
+} /* bs2b_post_level() */
+
+void bs2b_set_level_fcut( t_bs2bdp bs2bdp, int fcut )
+{
+	uint32_t level;
+
+	if( NULL == bs2bdp ) return;
+
+	level = bs2bdp->level;
+	level &= 0xffff0000;
+	level |= ( uint32_t )fcut;
+	bs2b_set_level( bs2bdp, level );
+} /* bs2b_set_level_fcut() */
+
+int bs2b_get_level_fcut( t_bs2bdp bs2bdp )
+{
+	return( ( int )( bs2bdp->level & 0xffff ) );
+} /* bs2b_get_level_fcut() */
+
+void bs2b_set_level_feed( t_bs2bdp bs2bdp, int feed )
+{
+	uint32_t level;
+
+	if( NULL == bs2bdp ) return;
+
+	level = bs2bdp->level;
+	level &= ( uint32_t )0xffff;
+	level |= ( uint32_t )feed << 16;
+	bs2b_set_level( bs2bdp, level );
+} /* bs2b_set_level_feed() */
+
+int bs2b_get_level_feed( t_bs2bdp bs2bdp )
+{
+	return( ( int )( ( bs2bdp->level & 0xffff0000 ) >> 16 ) );
+} /* bs2b_get_level_feed() */
+
+int bs2b_get_level_delay( t_bs2bdp bs2bdp )
+{
+	int fcut;
+	
+	fcut = bs2bdp->level & 0xffff; /* get cut frequency */
+
+	if( ( fcut > BS2B_MAXFCUT ) || ( fcut < BS2B_MINFCUT ) )
+		return 0;
+
+	return bs2b_level_delay( fcut );
+} /* bs2b_get_level_delay() */
+
+void bs2b_set_srate( t_bs2bdp bs2bdp, uint32_t srate )
+{
+	if( NULL == bs2bdp ) return;
+
+	if( srate == bs2bdp->srate ) return;
+
+	bs2bdp->srate = srate;
+	init( bs2bdp );
+	stop_ramp( bs2bdp );
+	bs2b_clear( bs2bdp );
+} /* bs2b_set_srate() */
+
+void bs2b_configure( t_bs2bdp bs2bdp, uint32_t srate, uint32_t level )
+{
+	if( NULL == bs2bdp ) return;
+
+	if( srate != bs2bdp->srate )
+		bs2b_clear( bs2bdp );
+
+	bs2bdp->srate = srate;
+	bs2bdp->level = level;
+	check_params( bs2bdp );
+	stop_ramp( bs2bdp );
+	bs2bdp->lazy = 1;
+} /* bs2b_configure() */
+
+uint32_t bs2b_get_srate( t_bs2bdp bs2bdp )
+{
+	return bs2bdp->srate;
+} /* bs2b_get_srate() */
+
+void bs2b_clear( t_bs2bdp bs2bdp )
+{
+	if( NULL == bs2bdp ) return;
+	memset( &bs2bdp->lfs, 0, sizeof( bs2bdp->lfs ) );
+	memset( &bs2bdp->lfsf, 0, sizeof( bs2bdp->lfsf ) );
+	memset( &bs2bdp->lfsq, 0, sizeof( bs2bdp->lfsq ) );
+} /* bs2b_clear() */
+
+int bs2b_is_clear( t_bs2bdp bs2bdp )
+{
+	int loopv = sizeof( bs2bdp->lfs );
+
+	while( loopv )
+	{
+		if( ( ( char * )&bs2bdp->lfs )[ --loopv ] != 0 )
+			return 0;
+	}
+
+	loopv = sizeof( bs2bdp->lfsf );
+
+	while( loopv )
+	{
+		if( ( ( char * )&bs2bdp->lfsf )[ --loopv ] != 0 )
+			return 0;
+	}
+
+	loopv = sizeof( bs2bdp->lfsq );
+
+	while( loopv )
+	{
+		if( ( ( char * )&bs2bdp->lfsq )[ --loopv ] != 0 )
+			return 0;
+	}
+
+	return 1;
+} /* bs2b_is_clear() */
+
+void bs2b_advance_silence( t_bs2bdp bs2bdp, size_t n )
+{
+	double lo, hi, x;
+	int    i;
+
+	if( NULL == bs2bdp || 0 == n ) return;
+
+	if( bs2bdp->lazy ) init( bs2bdp );
+
+	/* After 'n' zeros: lo[ n ] = b1_lo^n * lo[ 0 ],
+	 * hi[ n ] = b1_hi^( n - 1 ) * ( a1_hi * asis[ 0 ] + b1_hi * hi[ 0 ] )
+	 */
+	lo = pow( bs2bdp->b1_lo, ( double )n );
+	hi = pow( bs2bdp->b1_hi, ( double )( n - 1 ) );
+
+	for( i = 0; i < 2; i++ )
+	{
+		bs2bdp->lfs.lo[ i ] *= lo;
+		bs2bdp->lfs.hi[ i ] = hi * ( bs2bdp->a1_hi * bs2bdp->lfs.asis[ i ] +
+			bs2bdp->b1_hi * bs2bdp->lfs.hi[ i ] );
+		bs2bdp->lfs.asis[ i ] = 0.0;
+
+		bs2bdp->lfsf.lo[ i ] = ( float )( lo * bs2bdp->lfsf.lo[ i ] );
+		bs2bdp->lfsf.hi[ i ] = ( float )( hi *
+			( bs2bdp->f.a1_hi * bs2bdp->lfsf.asis[ i ] +
+			bs2bdp->f.b1_hi * bs2bdp->lfsf.hi[ i ] ) );
+		bs2bdp->lfsf.asis[ i ] = 0.0f;
+
+		/* Rounded once, a buffer does not stick at a few LSBs
+		 * as it does being rounded sample by sample
+		 */
+		x = bs2bdp->lfsq.lo[ i ] * lo;
+		bs2bdp->lfsq.lo[ i ] = ( int32_t )floor( x + 0.5 );
+		x = hi * ( bs2bdp->q.a1_hi / 1073741824.0 * bs2bdp->lfsq.asis[ i ] +
+			bs2bdp->q.b1_hi / 1073741824.0 * bs2bdp->lfsq.hi[ i ] );
+		bs2bdp->lfsq.hi[ i ] = ( int32_t )floor( x + 0.5 );
+		bs2bdp->lfsq.asis[ i ] = 0;
+	}
+} /* bs2b_advance_silence() */
+
+size_t bs2b_settle_frames( t_bs2bdp bs2bdp, double eps )
+{
+	double lo, hi, n_lo, n_hi;
+
+	if( NULL == bs2bdp || eps <= 0.0 ) return 0;
+
+	if( bs2bdp->lazy ) init( bs2bdp );
+
+	/* Largest differences of buffers for full scale input,
+	 * a highboost one includes a previous input sample
+	 */
+	lo = 2.0 * bs2bdp->a0_lo / ( 1.0 - bs2bdp->b1_lo );
+	hi = 2.0 * ( fabs( bs2bdp->a0_hi ) + fabs( bs2bdp->a1_hi ) ) /
+		( 1.0 - bs2bdp->b1_hi ) + 2.0 * fabs( bs2bdp->a1_hi );
+
+	/* Both decay by poles under a half of 'eps' of output */
+	n_lo = log( eps / ( 2.0 * bs2bdp->gain * lo ) ) / log( bs2bdp->b1_lo );
+	n_hi = log( eps / ( 2.0 * bs2bdp->gain * hi ) ) / log( bs2bdp->b1_hi );
+
+	if( n_hi > n_lo ) n_lo = n_hi;
+
+	return n_lo > 0.0 ? ( size_t )ceil( n_lo ) : 0;
+} /* bs2b_settle_frames() */
+
+void bs2b_set_flags( t_bs2bdp bs2bdp, uint32_t flags )
+{
+	int i;
+
+	if( NULL == bs2bdp ) return;
+
+	/* Carry the buffer over to the engine being switched on */
+	if( ( flags ^ bs2bdp->flags ) & BS2B_FLAG_FLOAT )
+	{
+		if( flags & BS2B_FLAG_FLOAT )
+		{
+			for( i = 0; i < 2; i++ )
+			{
+				bs2bdp->lfsf.asis[ i ] = ( float )bs2bdp->lfs.asis[ i ];
+				bs2bdp->lfsf.lo[ i ]   = ( float )bs2bdp->lfs.lo[ i ];
+				bs2bdp->lfsf.hi[ i ]   = ( float )bs2bdp->lfs.hi[ i ];
+			}
+			memset( &bs2bdp->lfs, 0, sizeof( bs2bdp->lfs ) );
+		}
+		else
+		{
+			for( i = 0; i < 2; i++ )
+			{
+				bs2bdp->lfs.asis[ i ] = ( double )bs2bdp->lfsf.asis[ i ];
+				bs2bdp->lfs.lo[ i ]   = ( double )bs2bdp->lfsf.lo[ i ];
+				bs2bdp->lfs.hi[ i ]   = ( double )bs2bdp->lfsf.hi[ i ];
+			}
+			memset( &bs2bdp->lfsf, 0, sizeof( bs2bdp->lfsf ) );
+		}
+	}
+
+	/* A fixed-point buffer is scaled by the format, it is not carried */
+	if( ( flags ^ bs2bdp->flags ) & BS2B_FLAG_FIXED )
+	{
+		memset( &bs2bdp->lfs, 0, sizeof( bs2bdp->lfs ) );
+		memset( &bs2bdp->lfsq, 0, sizeof( bs2bdp->lfsq ) );
+	}
+
+	bs2bdp->flags = flags;
+} /* bs2b_set_flags() */
+
+uint32_t bs2b_get_flags( t_bs2bdp bs2bdp )
+{
+	return bs2bdp->flags;
+} /* bs2b_get_flags() */
+
+void bs2b_set_silence_level( t_bs2bdp bs2bdp, double level )
+{
+	if( NULL == bs2bdp ) return;
+
+	bs2bdp->silence = level;
+} /* bs2b_set_silence_level() */
+
+double bs2b_get_silence_level( t_bs2bdp bs2bdp )
+{
+	return bs2bdp->silence;
+} /* bs2b_get_silence_level() */
+
+size_t bs2b_get_skipped( t_bs2bdp bs2bdp )
+{
+	return bs2bdp->skipped;
+} /* bs2b_get_skipped() */
+
+void bs2b_reset_skipped( t_bs2bdp bs2bdp )
+{
+	if( NULL == bs2bdp ) return;
+
+	bs2bdp->skipped = 0;
+} /* bs2b_reset_skipped() */
+
+char const *bs2b_runtime_version( void )
+{
+	return BS2B_VERSION_STR;
+} /* bs2b_runtime_version() */
+
+uint32_t bs2b_runtime_version_int( void )
+{
+	return BS2B_VERSION_INT;
+} /* bs2b_runtime_version_int() */
+
+int bs2b_get_kernel( void )
+{
+	if( !kernel_ready ) select_kernel();
+	return kernel.id;
+} /* bs2b_get_kernel() */
+
+char const *bs2b_get_kernel_name( void )
+{
+	if( !kernel_ready ) select_kernel();
+	return kernel.name;
+} /* bs2b_get_kernel_name() */
+
+void bs2b_cross_feed_d( t_bs2bdp bs2bdp, double *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_D );
+} /* bs2b_cross_feed_d() */
+
+void bs2b_cross_feed_dbe( t_bs2bdp bs2bdp, double *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_D ) );
+} /* bs2b_cross_feed_dbe() */
+
+void bs2b_cross_feed_dle( t_bs2bdp bs2bdp, double *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_D ) );
+} /* bs2b_cross_feed_dle() */
+
+void bs2b_cross_feed_f( t_bs2bdp bs2bdp, float *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_F );
+} /* bs2b_cross_feed_f() */
+
+void bs2b_cross_feed_fbe( t_bs2bdp bs2bdp, float *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_F ) );
+} /* bs2b_cross_feed_fbe() */
+
+void bs2b_cross_feed_fle( t_bs2bdp bs2bdp, float *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_F ) );
+} /* bs2b_cross_feed_fle() */
+
+void bs2b_cross_feed_s32( t_bs2bdp bs2bdp, int32_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_S32 );
+} /* bs2b_cross_feed_s32() */
+
+void bs2b_cross_feed_u32( t_bs2bdp bs2bdp, uint32_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_U32 );
+} /* bs2b_cross_feed_u32() */
+
+void bs2b_cross_feed_s32be( t_bs2bdp bs2bdp, int32_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_S32 ) );
+} /* bs2b_cross_feed_s32be() */
+
+void bs2b_cross_feed_u32be( t_bs2bdp bs2bdp, uint32_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_U32 ) );
+} /* bs2b_cross_feed_u32be() */
+
+void bs2b_cross_feed_s32le( t_bs2bdp bs2bdp, int32_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_S32 ) );
+} /* bs2b_cross_feed_s32le() */
+
+void bs2b_cross_feed_u32le( t_bs2bdp bs2bdp, uint32_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_U32 ) );
+} /* bs2b_cross_feed_u32le() */
+
+void bs2b_cross_feed_s16( t_bs2bdp bs2bdp, int16_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_S16 );
+} /* bs2b_cross_feed_s16() */
+
+void bs2b_cross_feed_u16( t_bs2bdp bs2bdp, uint16_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_U16 );
+} /* bs2b_cross_feed_u16() */
+
+void bs2b_cross_feed_s16be( t_bs2bdp bs2bdp, int16_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_S16 ) );
+} /* bs2b_cross_feed_s16be() */
+
+void bs2b_cross_feed_u16be( t_bs2bdp bs2bdp, uint16_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_U16 ) );
+} /* bs2b_cross_feed_u16be() */
+
+void bs2b_cross_feed_s16le( t_bs2bdp bs2bdp, int16_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_S16 ) );
+} /* bs2b_cross_feed_s16le() */
+
+void bs2b_cross_feed_u16le( t_bs2bdp bs2bdp, uint16_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_U16 ) );
+} /* bs2b_cross_feed_u16le() */
+
+void bs2b_cross_feed_s8( t_bs2bdp bs2bdp, int8_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_S8 );
+} /* bs2b_cross_feed_s8() */
+
+void bs2b_cross_feed_u8( t_bs2bdp bs2bdp, uint8_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_U8 );
+} /* bs2b_cross_feed_u8() */
+
+void bs2b_cross_feed_s24( t_bs2bdp bs2bdp, bs2b_int24_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_S24 );
+} /* bs2b_cross_feed_s24() */
+
+void bs2b_cross_feed_u24( t_bs2bdp bs2bdp, bs2b_uint24_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, BS2B_FMT_U24 );
+} /* bs2b_cross_feed_u24() */
+
+void bs2b_cross_feed_s24be( t_bs2bdp bs2bdp, bs2b_int24_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_S24 ) );
+} /* bs2b_cross_feed_s24be() */
+
+void bs2b_cross_feed_u24be( t_bs2bdp bs2bdp, bs2b_uint24_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_BE( BS2B_FMT_U24 ) );
+} /* bs2b_cross_feed_u24be() */
+
+void bs2b_cross_feed_s24le( t_bs2bdp bs2bdp, bs2b_int24_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_S24 ) );
+} /* bs2b_cross_feed_s24le() */
+
+void bs2b_cross_feed_u24le( t_bs2bdp bs2bdp, bs2b_uint24_t *sample, int n )
+{
+	cross_feed( bs2bdp, sample, n, FMT_LE( BS2B_FMT_U24 ) );
+} /* bs2b_cross_feed_u24le() */
+
+void bs2b_cross_feed_d_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_D );
+} /* bs2b_cross_feed_d_to() */
+
+void bs2b_cross_feed_dbe_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_D ) );
+} /* bs2b_cross_feed_dbe_to() */
+
+void bs2b_cross_feed_dle_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_D ) );
+} /* bs2b_cross_feed_dle_to() */
+
+void bs2b_cross_feed_f_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_F );
+} /* bs2b_cross_feed_f_to() */
+
+void bs2b_cross_feed_fbe_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_F ) );
+} /* bs2b_cross_feed_fbe_to() */
+
+void bs2b_cross_feed_fle_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_F ) );
+} /* bs2b_cross_feed_fle_to() */
+
+void bs2b_cross_feed_s32_to( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_S32 );
+} /* bs2b_cross_feed_s32_to() */
+
+void bs2b_cross_feed_u32_to( t_bs2bdp bs2bdp,
+	uint32_t const *in, uint32_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_U32 );
+} /* bs2b_cross_feed_u32_to() */
+
+void bs2b_cross_feed_s32be_to( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_S32 ) );
+} /* bs2b_cross_feed_s32be_to() */
+
+void bs2b_cross_feed_u32be_to( t_bs2bdp bs2bdp,
+	uint32_t const *in, uint32_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_U32 ) );
+} /* bs2b_cross_feed_u32be_to() */
+
+void bs2b_cross_feed_s32le_to( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_S32 ) );
+} /* bs2b_cross_feed_s32le_to() */
+
+void bs2b_cross_feed_u32le_to( t_bs2bdp bs2bdp,
+	uint32_t const *in, uint32_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_U32 ) );
+} /* bs2b_cross_feed_u32le_to() */
+
+void bs2b_cross_feed_s16_to( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_S16 );
+} /* bs2b_cross_feed_s16_to() */
+
+void bs2b_cross_feed_u16_to( t_bs2bdp bs2bdp,
+	uint16_t const *in, uint16_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_U16 );
+} /* bs2b_cross_feed_u16_to() */
+
+void bs2b_cross_feed_s16be_to( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_S16 ) );
+} /* bs2b_cross_feed_s16be_to() */
+
+void bs2b_cross_feed_u16be_to( t_bs2bdp bs2bdp,
+	uint16_t const *in, uint16_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_U16 ) );
+} /* bs2b_cross_feed_u16be_to() */
+
+void bs2b_cross_feed_s16le_to( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_S16 ) );
+} /* bs2b_cross_feed_s16le_to() */
+
+void bs2b_cross_feed_u16le_to( t_bs2bdp bs2bdp,
+	uint16_t const *in, uint16_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_U16 ) );
+} /* bs2b_cross_feed_u16le_to() */
+
+void bs2b_cross_feed_s8_to( t_bs2bdp bs2bdp,
+	int8_t const *in, int8_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_S8 );
+} /* bs2b_cross_feed_s8_to() */
+
+void bs2b_cross_feed_u8_to( t_bs2bdp bs2bdp,
+	uint8_t const *in, uint8_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_U8 );
+} /* bs2b_cross_feed_u8_to() */
+
+void bs2b_cross_feed_s24_to( t_bs2bdp bs2bdp,
+	bs2b_int24_t const *in, bs2b_int24_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_S24 );
+} /* bs2b_cross_feed_s24_to() */
+
+void bs2b_cross_feed_u24_to( t_bs2bdp bs2bdp,
+	bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, BS2B_FMT_U24 );
+} /* bs2b_cross_feed_u24_to() */
+
+void bs2b_cross_feed_s24be_to( t_bs2bdp bs2bdp,
+	bs2b_int24_t const *in, bs2b_int24_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_S24 ) );
+} /* bs2b_cross_feed_s24be_to() */
+
+void bs2b_cross_feed_u24be_to( t_bs2bdp bs2bdp,
+	bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_BE( BS2B_FMT_U24 ) );
+} /* bs2b_cross_feed_u24be_to() */
+
+void bs2b_cross_feed_s24le_to( t_bs2bdp bs2bdp,
+	bs2b_int24_t const *in, bs2b_int24_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_S24 ) );
+} /* bs2b_cross_feed_s24le_to() */
+
+void bs2b_cross_feed_u24le_to( t_bs2bdp bs2bdp,
+	bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n )
+{
+	cross_feed_to( bs2bdp, in, out, n, FMT_LE( BS2B_FMT_U24 ) );
+} /* bs2b_cross_feed_u24le_to() */
+
+void bs2b_cross_feed_planar_d( t_bs2bdp bs2bdp,
+	double *left, double *right, size_t n )
+{
+	cross_feed_planar( bs2bdp, left, right, left, right, n, BS2B_FMT_D );
+} /* bs2b_cross_feed_planar_d() */
+
+void bs2b_cross_feed_planar_f( t_bs2bdp bs2bdp,
+	float *left, float *right, size_t n )
+{
+	cross_feed_planar( bs2bdp, left, right, left, right, n, BS2B_FMT_F );
+} /* bs2b_cross_feed_planar_f() */
+
+void bs2b_cross_feed_planar_d_to( t_bs2bdp bs2bdp,
+	double const *in_left, double const *in_right,
+	double *out_left, double *out_right, size_t n )
+{
+	cross_feed_planar( bs2bdp, in_left, in_right, out_left, out_right, n,
+		BS2B_FMT_D );
+} /* bs2b_cross_feed_planar_d_to() */
+
+void bs2b_cross_feed_planar_f_to( t_bs2bdp bs2bdp,
+	float const *in_left, float const *in_right,
+	float *out_left, float *out_right, size_t n )
+{
+	cross_feed_planar( bs2bdp, in_left, in_right, out_left, out_right, n,
+		BS2B_FMT_F );
+} /* bs2b_cross_feed_planar_f_to() */
+
+void bs2b_cross_feed_stride_d( t_bs2bdp bs2bdp, double *sample, size_t n,
+	int channels, int left, int right )
+{
+	int pair[ 2 ];
+
+	pair[ 0 ] = left;
+	pair[ 1 ] = right;
+	cross_feed_pairs( &bs2bdp, pair, 1, sample, n, channels, BS2B_FMT_D );
+} /* bs2b_cross_feed_stride_d() */
+
+void bs2b_cross_feed_stride_f( t_bs2bdp bs2bdp, float *sample, size_t n,
+	int channels, int left, int right )
+{
+	int pair[ 2 ];
+
+	pair[ 0 ] = left;
+	pair[ 1 ] = right;
+	cross_feed_pairs( &bs2bdp, pair, 1, sample, n, channels, BS2B_FMT_F );
+} /* bs2b_cross_feed_stride_f() */
+
+void bs2b_cross_feed_pairs_d( t_bs2bdp const *bs2bdp, int const *pairs,
+	int count, double *sample, size_t n, int channels )
+{
+	cross_feed_pairs( bs2bdp, pairs, count, sample, n, channels, BS2B_FMT_D );
+} /* bs2b_cross_feed_pairs_d() */
+
+void bs2b_cross_feed_pairs_f( t_bs2bdp const *bs2bdp, int const *pairs,
+	int count, float *sample, size_t n, int channels )
+{
+	cross_feed_pairs( bs2bdp, pairs, count, sample, n, channels, BS2B_FMT_F );
+} /* bs2b_cross_feed_pairs_f() */
+
+void bs2b_cross_feed_events_d( t_bs2bdp bs2bdp, double *sample, size_t n,
+	t_bs2b_event const *event, size_t count )
+{
+	cross_feed_events( bs2bdp, sample, sample, n, BS2B_FMT_D,
+		event, count );
+} /* bs2b_cross_feed_events_d() */
+
+void bs2b_cross_feed_events_f( t_bs2bdp bs2bdp, float *sample, size_t n,
+	t_bs2b_event const *event, size_t count )
+{
+	cross_feed_events( bs2bdp, sample, sample, n, BS2B_FMT_F,
+		event, count );
+} /* bs2b_cross_feed_events_f() */
+
+void bs2b_cross_feed_events_d_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n,
+	t_bs2b_event const *event, size_t count )
+{
+	cross_feed_events( bs2bdp, in, out, n, BS2B_FMT_D, event, count );
+} /* bs2b_cross_feed_events_d_to() */
+
+void bs2b_cross_feed_events_f_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n,
+	t_bs2b_event const *event, size_t count )
+{
+	cross_feed_events( bs2bdp, in, out, n, BS2B_FMT_F, event, count );
+} /* bs2b_cross_feed_events_f_to() */
+
+t_bs2b_batchp bs2b_batch_open( size_t count )
+{
+	t_bs2b_batchp batch;
+	size_t        lanes, k;
+	float         *x;
+	int           c;
+
+	if( !kernel_ready ) select_kernel();
+
+	lanes = ( count + BS2B_BATCH_LANES - 1 ) /
+		BS2B_BATCH_LANES * BS2B_BATCH_LANES;
+	if( lanes < count ) return NULL;
+
+	/* Arrays follow the batch */
+	if( NULL == ( batch = malloc( sizeof( t_bs2b_batch ) +
+		lanes * ( 2 * sizeof( uint32_t ) + 12 * sizeof( float ) ) ) ) )
+		return NULL;
+
+	memset( batch, 0, sizeof( t_bs2b_batch ) +
+		lanes * ( 2 * sizeof( uint32_t ) + 12 * sizeof( float ) ) );
+
+	batch->count = count;
+	batch->lanes = lanes;
+	batch->level = ( uint32_t * )( batch + 1 );
+	batch->srate = batch->level + lanes;
+
+	x = ( float * )( batch->srate + lanes );
+	batch->a0_lo = x;
+	batch->b1_lo = x += lanes;
+	batch->a0_hi = x += lanes;
+	batch->a1_hi = x += lanes;
+	batch->b1_hi = x += lanes;
+	batch->gain  = x += lanes;
+
+	for( c = 0; c < 2; c++ )
+	{
+		batch->asis[ c ] = x += lanes;
+		batch->lo[ c ]   = x += lanes;
+		batch->hi[ c ]   = x += lanes;
+	}
+
+	for( k = 0; k < count; k++ )
+		bs2b_batch_configure( batch, k,
+			BS2B_DEFAULT_SRATE, BS2B_DEFAULT_CLEVEL );
+
+	return batch;
+} /* bs2b_batch_open() */
+
+void bs2b_batch_close( t_bs2b_batchp batch )
+{
+	free( batch );
+} /* bs2b_batch_close() */
+
+void bs2b_batch_configure( t_bs2b_batchp batch, size_t stream,
+	uint32_t srate, uint32_t level )
+{
+	t_bs2bd bs2bd;
+
+	if( NULL == batch || stream >= batch->count ) return;
+
+	/* Coefficients of presets and the cache */
+	memset( &bs2bd, 0, sizeof( bs2bd ) );
+	bs2bd.srate = srate;
+	bs2bd.level = level;
+	init( &bs2bd );
+
+	if( bs2bd.srate != batch->srate[ stream ] )
+		bs2b_batch_clear( batch, stream );
+
+	batch->level[ stream ] = bs2bd.level;
+	batch->srate[ stream ] = bs2bd.srate;
+	batch->a0_lo[ stream ] = bs2bd.f.a0_lo;
+	batch->b1_lo[ stream ] = bs2bd.f.b1_lo;
+	batch->a0_hi[ stream ] = bs2bd.f.a0_hi;
+	batch->a1_hi[ stream ] = bs2bd.f.a1_hi;
+	batch->b1_hi[ stream ] = bs2bd.f.b1_hi;
+	batch->gain[ stream ]  = bs2bd.f.gain;
+} /* bs2b_batch_configure() */
+
+void bs2b_batch_clear( t_bs2b_batchp batch, size_t stream )
+{
+	int c;
+
+	if( NULL == batch || stream >= batch->count ) return;
+
+	for( c = 0; c < 2; c++ )
+	{
+		batch->asis[ c ][ stream ] = 0.0f;
+		batch->lo[ c ][ stream ]   = 0.0f;
+		batch->hi[ c ][ stream ]   = 0.0f;
+	}
+} /* bs2b_batch_clear() */
+
+void bs2b_batch_cross_feed_f( t_bs2b_batchp batch, float * const *sample,
+	size_t n )
+{
+	unsigned int mode;
+	size_t       first;
+
+	if( NULL == batch || 0 == n ) return;
+
+	mode = kernel.flush_fpu();
+
+	for( first = 0; first < batch->count; first += BS2B_BATCH_LANES )
+		cross_feed_batch( batch, sample, first, n );
+
+	kernel.restore_fpu( mode );
+} /* bs2b_batch_cross_feed_f() */
+
+void bs2b_cross_feed_parallel_d( t_bs2bdp bs2bdp, double *sample, size_t n,
+	int threads )
+{
+	cross_feed_parallel( bs2bdp, sample, sample, n, threads );
+} /* bs2b_cross_feed_parallel_d() */
+
+void bs2b_cross_feed_parallel_d_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n, int threads )
+{
+	cross_feed_parallel( bs2bdp, in, out, n, threads );
+} /* bs2b_cross_feed_parallel_d_to() */
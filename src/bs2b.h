@@ -24,6 +24,8 @@
 #ifndef BS2B_H
 #define BS2B_H
 
+#include <stddef.h>
+
 #include "bs2bversion.h"
 #include "bs2btypes.h"
 
@@ -57,9 +59,29 @@
 #define BS2B_CMOY_CLEVEL     ( ( uint32_t )700 | ( ( uint32_t )60 << 16 ) )
 #define BS2B_JMEIER_CLEVEL   ( ( uint32_t )650 | ( ( uint32_t )95 << 16 ) )
 
+/* Processing kernels */
+/* bs2b_get_kernel() */
+#define BS2B_KERNEL_SCALAR   0
+#define BS2B_KERNEL_SSE2     1
+#define BS2B_KERNEL_AVX2     2
+#define BS2B_KERNEL_AVX512   3
+
+/* Processing options */
+/* bs2b_set_flags() */
+#define BS2B_FLAG_FLOAT      0x0001 /* Single precision 'bs2b_cross_feed_f*' */
+#define BS2B_FLAG_FIXED      0x0002 /* Fixed-point 'bs2b_cross_feed_s16/s32' */
+#define BS2B_FLAG_DENORMAL_SAFE 0x0004 /* Bounded cost on fading input */
+#define BS2B_FLAG_SKIP_SILENCE  0x0008 /* Skip silent blocks of faded state */
+#define BS2B_FLAG_RAMP       0x0010 /* Ramp to posted coefficients */
+#define BS2B_FLAG_LOOKAHEAD  0x0020 /* Several stereo samples per step */
+
 /* Default sample rate (Hz) */
 #define BS2B_DEFAULT_SRATE   44100
 
+/* Default silence level against full scale ( -140 dB ) */
+/* bs2b_set_silence_level() */
+#define BS2B_DEFAULT_SILENCE 1e-7
+
 /* A delay at low frequency by microseconds according to cut frequency */
 #define bs2b_level_delay( fcut ) ( ( 18700 / fcut ) * 10 )
 
@@ -72,10 +94,49 @@ typedef struct
 	double gain;                 /* Global gain against overloading */
 	/* Buffer of last filtered sample: [0] 1-st channel, [1] 2-d channel */
 	struct { double asis[ 2 ], lo[ 2 ], hi[ 2 ]; } lfs;
+	uint32_t flags;              /* Processing options, BS2B_FLAG_* */
+	/* Single precision coefficients and buffer, BS2B_FLAG_FLOAT */
+	struct { float a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain; } f;
+	struct { float asis[ 2 ], lo[ 2 ], hi[ 2 ]; } lfsf;
+	/* Q30 fixed-point coefficients and buffer, BS2B_FLAG_FIXED */
+	struct { int32_t a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain; } q;
+	struct { int32_t asis[ 2 ], lo[ 2 ], hi[ 2 ]; } lfsq;
+	double silence;              /* Silence level, BS2B_FLAG_SKIP_SILENCE */
+	size_t skipped;              /* Number of skipped stereo samples */
+	int lazy;                    /* Coefficients are set on crossfeeding */
+	void *post;                  /* Posted coefficients, bs2b_post_level() */
 } t_bs2bd;
 
 typedef t_bs2bd *t_bs2bdp;
 
+/* A change of crossfeed level at a stereo sample inside a buffer,
+ * bs2b_cross_feed_events_*()
+ */
+typedef struct
+{
+	size_t   frame;              /* Offset from the start of the buffer */
+	uint32_t level;              /* New crossfeed level, bs2b_set_level() */
+} t_bs2b_event;
+
+/* Streams of a batch are processed in groups of this many SIMD lanes */
+#define BS2B_BATCH_LANES     16
+
+/* Independent stereo streams crossfed at once, one stream per SIMD lane,
+ * bs2b_batch_*(). Arrays are indexed by stream and padded to 'lanes'.
+ */
+typedef struct
+{
+	size_t count;                /* Number of streams */
+	size_t lanes;                /* 'count' rounded up to BS2B_BATCH_LANES */
+	uint32_t *level;             /* Crossfeed levels */
+	uint32_t *srate;             /* Sample rates (Hz) */
+	/* Single precision coefficients and buffers */
+	float *a0_lo, *b1_lo, *a0_hi, *a1_hi, *b1_hi, *gain;
+	float *asis[ 2 ], *lo[ 2 ], *hi[ 2 ];
+} t_bs2b_batch;
+
+typedef t_bs2b_batch *t_bs2b_batchp;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -99,6 +160,14 @@ void bs2b_set_level( t_bs2bdp bs2bdp, uint32_t level );
 /* Return a current crossfeed level value. */
 uint32_t bs2b_get_level( t_bs2bdp bs2bdp );
 
+/* Posts a new crossfeed level from a control thread while another
+ * thread may be crossfeeding. Coefficients are computed here and taken
+ * by crossfeeding at the next block of up to 256 stereo samples
+ * without locks, see BS2B_FLAG_RAMP. Only one thread may post at once,
+ * sample rate must not be changed concurrently.
+ */
+void bs2b_post_level( t_bs2bdp bs2bdp, uint32_t level );
+
 /* Sets a new coefficients by new cut frecuency value (Hz). */
 void bs2b_set_level_fcut( t_bs2bdp bs2bdp, int fcut );
 
@@ -119,6 +188,13 @@ int bs2b_get_level_delay( t_bs2bdp bs2bdp );
  */
 void bs2b_set_srate( t_bs2bdp bs2bdp, uint32_t srate );
 
+/* Sets sample rate and crossfeed level at once. Coefficients are set
+ * on the first crossfeeding, so configuring is cheap for instances
+ * which are reconfigured or closed before processing. Buffer is cleared
+ * if sample rate changes. Out of range values are replaced by defaults.
+ */
+void bs2b_configure( t_bs2bdp bs2bdp, uint32_t srate, uint32_t level );
+
 /* Return current sample rate value */
 uint32_t bs2b_get_srate( t_bs2bdp bs2bdp );
 
@@ -128,12 +204,108 @@ void bs2b_clear( t_bs2bdp bs2bdp );
 /* Return 1 if buffer is clear */
 int bs2b_is_clear( t_bs2bdp bs2bdp );
 
+/* Advances the buffer by 'n' stereo samples of silence at a constant
+ * cost, as if 'n' zero samples were crossfed and the output discarded.
+ * Double and float buffers match crossfeeding within rounding errors,
+ * the Q30 buffer is rounded once instead of every sample.
+ */
+void bs2b_advance_silence( t_bs2bdp bs2bdp, size_t n );
+
+/* Return a number of stereo samples after which output does not depend
+ * on a buffer before them by more than 'eps' for full scale ( +/-1.0 )
+ * input, as filters forget it by their poles. It is a warm-up pre-roll
+ * for parts of a stream crossfed independently from cleared buffers.
+ * Depends on the crossfeed level and sample rate, e.g. for 1e-10 it is
+ * 235 stereo samples at 44100 Hz and the default level, 4589 at
+ * 384000 Hz and 300 Hz.
+ */
+size_t bs2b_settle_frames( t_bs2bdp bs2bdp, double eps );
+
+/* Sets processing options, a combination of BS2B_FLAG_* values.
+ *
+ * BS2B_FLAG_FLOAT - 'bs2b_cross_feed_f*' run on single precision
+ * coefficients and buffer instead of converting samples to doubles.
+ * The buffer is carried over on switching. Against the double
+ * precision engine a maximal deviation for full scale ( +/-1.0 ) noise
+ * is about 3e-7 at 44100 Hz and grows with sample rate and lower cut
+ * frequency up to about 1e-6 ( -120 dB ) at 384000 Hz and 300 Hz.
+ *
+ * BS2B_FLAG_FIXED - native endian 'bs2b_cross_feed_s16*' and
+ * 'bs2b_cross_feed_s32*' run on Q30 integer coefficients and buffer
+ * without conversion of samples to doubles. Samples are scaled to Q30
+ * ( 16 bit ones by 2^15, 32 bit ones by 2^-1 ), products are 64 bit.
+ * Against the double precision engine the noise floor is about -158 dB
+ * of full scale: 16 bit output differs by 1 LSB in about 4 of 100000
+ * samples, 32 bit output by up to about 25 LSBs.
+ * The buffer is cleared on switching, as its scale depends on a format.
+ *
+ * BS2B_FLAG_DENORMAL_SAFE - keeps filters out of denormal numbers, which
+ * cost up to about a hundred times more per operation on x86. Without it
+ * a fading tail followed by silence leaves the buffer at the smallest
+ * denormals forever. Denormals are flushed to zero by MXCSR ( SSE2 and
+ * later kernels ) during the call, the previous mode is restored on
+ * return. Besides, buffer values below 1e-30 are snapped to zero after
+ * every block of up to 256 stereo samples on any CPU.
+ *
+ * BS2B_FLAG_SKIP_SILENCE - blocks of up to 256 stereo samples of zeros
+ * are not filtered when the buffer has faded under the silence level,
+ * see bs2b_set_silence_level(). The buffer is cleared, output samples
+ * are zeros, in place ones are not written at all. Unsigned formats,
+ * whose silence is not zero bytes, are always filtered.
+ *
+ * BS2B_FLAG_RAMP - coefficients posted by bs2b_post_level() are reached
+ * by linear steps per block over 8 blocks ( 2048 stereo samples )
+ * instead of at once, so that level changes do not click.
+ *
+ * BS2B_FLAG_LOOKAHEAD - the double precision engine computes several
+ * stereo samples per step from the state before them ( a look-ahead
+ * recurrence with powers of the filter poles ), so that the filters are
+ * no longer limited by one dependent operation per stereo sample.
+ * Steps are 4 stereo samples on AVX2 and AVX-512 kernels, 2 on SSE2,
+ * the scalar kernel runs the plain filters. Output differs from the
+ * plain engine within rounding, for full scale ( +/-1.0 ) noise by at
+ * most about 3e-15 ( -290 dB ) at 8000 to 384000 Hz and any level.
+ */
+void bs2b_set_flags( t_bs2bdp bs2bdp, uint32_t flags );
+
+/* Return current processing options. */
+uint32_t bs2b_get_flags( t_bs2bdp bs2bdp );
+
+/* Sets a level of the buffer against full scale ( 1.0 ) under which
+ * silent blocks are skipped, BS2B_FLAG_SKIP_SILENCE.
+ * Default is BS2B_DEFAULT_SILENCE.
+ */
+void bs2b_set_silence_level( t_bs2bdp bs2bdp, double level );
+
+/* Return a current silence level. */
+double bs2b_get_silence_level( t_bs2bdp bs2bdp );
+
+/* Return a number of stereo samples skipped as silence
+ * since bs2b_open() or bs2b_reset_skipped().
+ */
+size_t bs2b_get_skipped( t_bs2bdp bs2bdp );
+
+/* Resets the number of skipped stereo samples. */
+void bs2b_reset_skipped( t_bs2bdp bs2bdp );
+
 /* Return bs2b version string */
 char const *bs2b_runtime_version( void );
 
 /* Return bs2b version integer */
 uint32_t bs2b_runtime_version_int( void );
 
+/* Return a processing kernel (BS2B_KERNEL_*) used by 'bs2b_cross_feed_*'.
+ * The best kernel supported by CPU is selected once at load time.
+ * The BS2B_KERNEL environment variable (scalar, sse2, avx2 or avx512)
+ * forces a lower one. The scalar and SSE2 kernels are bit-exact,
+ * AVX2 and AVX-512 kernels use fused multiply-add and differ
+ * from them within rounding.
+ */
+int bs2b_get_kernel( void );
+
+/* Return a name of processing kernel. */
+char const *bs2b_get_kernel_name( void );
+
 /* 'bs2b_cross_feed_*' crossfeeds buffer of 'n' stereo samples
  * pointed by 'sample'.
  * sample[i]   - first channel,
@@ -219,6 +391,186 @@ void bs2b_cross_feed_s24le( t_bs2bdp bs2bdp, bs2b_int24_t *sample, int n );
 /* sample poits to 24bit unsigned integers little endians */
 void bs2b_cross_feed_u24le( t_bs2bdp bs2bdp, bs2b_uint24_t *sample, int n );
 
+/* 'bs2b_cross_feed_*_to' crossfeeds 'n' stereo samples from 'in' to 'out'
+ * in the same formats as 'bs2b_cross_feed_*' above, 'in' stays intact.
+ * 'in' and 'out' may point to the same buffer, but must not overlap
+ * otherwise.
+ */
+void bs2b_cross_feed_d_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n );
+void bs2b_cross_feed_dbe_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n );
+void bs2b_cross_feed_dle_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n );
+void bs2b_cross_feed_f_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n );
+void bs2b_cross_feed_fbe_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n );
+void bs2b_cross_feed_fle_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n );
+void bs2b_cross_feed_s32_to( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, size_t n );
+void bs2b_cross_feed_u32_to( t_bs2bdp bs2bdp,
+	uint32_t const *in, uint32_t *out, size_t n );
+void bs2b_cross_feed_s32be_to( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, size_t n );
+void bs2b_cross_feed_u32be_to( t_bs2bdp bs2bdp,
+	uint32_t const *in, uint32_t *out, size_t n );
+void bs2b_cross_feed_s32le_to( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, size_t n );
+void bs2b_cross_feed_u32le_to( t_bs2bdp bs2bdp,
+	uint32_t const *in, uint32_t *out, size_t n );
+void bs2b_cross_feed_s16_to( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, size_t n );
+void bs2b_cross_feed_u16_to( t_bs2bdp bs2bdp,
+	uint16_t const *in, uint16_t *out, size_t n );
+void bs2b_cross_feed_s16be_to( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, size_t n );
+void bs2b_cross_feed_u16be_to( t_bs2bdp bs2bdp,
+	uint16_t const *in, uint16_t *out, size_t n );
+void bs2b_cross_feed_s16le_to( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, size_t n );
+void bs2b_cross_feed_u16le_to( t_bs2bdp bs2bdp,
+	uint16_t const *in, uint16_t *out, size_t n );
+void bs2b_cross_feed_s8_to( t_bs2bdp bs2bdp,
+	int8_t const *in, int8_t *out, size_t n );
+void bs2b_cross_feed_u8_to( t_bs2bdp bs2bdp,
+	uint8_t const *in, uint8_t *out, size_t n );
+void bs2b_cross_feed_s24_to( t_bs2bdp bs2bdp,
+	bs2b_int24_t const *in, bs2b_int24_t *out, size_t n );
+void bs2b_cross_feed_u24_to( t_bs2bdp bs2bdp,
+	bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n );
+void bs2b_cross_feed_s24be_to( t_bs2bdp bs2bdp,
+	bs2b_int24_t const *in, bs2b_int24_t *out, size_t n );
+void bs2b_cross_feed_u24be_to( t_bs2bdp bs2bdp,
+	bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n );
+void bs2b_cross_feed_s24le_to( t_bs2bdp bs2bdp,
+	bs2b_int24_t const *in, bs2b_int24_t *out, size_t n );
+void bs2b_cross_feed_u24le_to( t_bs2bdp bs2bdp,
+	bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n );
+
+/* 'bs2b_cross_feed_planar_*' crossfeeds 'n' stereo samples of native
+ * endian doubles or floats kept in separate channel buffers.
+ * left[i]  - first channel,
+ * right[i] - second channel.
+ * Where 'i' is ( i = 0; i < n; i++ )
+ * The '_to' variants read 'in_*' buffers and write 'out_*' ones,
+ * an output buffer may be the same as the input one of its channel.
+ * Floats honour BS2B_FLAG_FLOAT.
+ */
+void bs2b_cross_feed_planar_d( t_bs2bdp bs2bdp,
+	double *left, double *right, size_t n );
+
+void bs2b_cross_feed_planar_f( t_bs2bdp bs2bdp,
+	float *left, float *right, size_t n );
+
+void bs2b_cross_feed_planar_d_to( t_bs2bdp bs2bdp,
+	double const *in_left, double const *in_right,
+	double *out_left, double *out_right, size_t n );
+
+void bs2b_cross_feed_planar_f_to( t_bs2bdp bs2bdp,
+	float const *in_left, float const *in_right,
+	float *out_left, float *out_right, size_t n );
+
+/* 'bs2b_cross_feed_stride_*' crossfeeds in place 'left' and 'right'
+ * channels of 'n' frames of 'channels' interleaved native endian
+ * doubles or floats, e.g. front channels of a 5.1 stream.
+ * sample[i+left]  - first channel,
+ * sample[i+right] - second channel.
+ * Where 'i' is ( i = 0; i < n * channels; i += channels )
+ * Nothing is done if a channel index is out of range.
+ */
+void bs2b_cross_feed_stride_d( t_bs2bdp bs2bdp, double *sample, size_t n,
+	int channels, int left, int right );
+
+void bs2b_cross_feed_stride_f( t_bs2bdp bs2bdp, float *sample, size_t n,
+	int channels, int left, int right );
+
+/* 'bs2b_cross_feed_pairs_*' crossfeeds 'count' channel pairs in the same
+ * layout, each pair by its own instance. bs2bdp[k] crossfeeds channels
+ * pairs[k*2] and pairs[k*2+1]. Pairs are processed together block by
+ * block, so the buffer passes cache once.
+ */
+void bs2b_cross_feed_pairs_d( t_bs2bdp const *bs2bdp, int const *pairs,
+	int count, double *sample, size_t n, int channels );
+
+void bs2b_cross_feed_pairs_f( t_bs2bdp const *bs2bdp, int const *pairs,
+	int count, float *sample, size_t n, int channels );
+
+/* 'bs2b_cross_feed_events_*' crossfeeds 'n' stereo samples of native
+ * endian doubles or floats in the layout of 'bs2b_cross_feed_*' and
+ * sets the crossfeed level of 'count' events sorted by frame exactly
+ * at their frames, as if the buffer were split there and
+ * bs2b_set_level() called between the parts. Of events at the same
+ * frame the last one is applied, events at or past 'n' are applied
+ * after the buffer. Coefficients of events are taken from presets or
+ * computed in place, without locks or allocation, so the functions are
+ * safe on a realtime audio thread. A level missing from presets costs
+ * a few exp() and pow() calls. The '_to' variants read 'in' and write
+ * 'out' as 'bs2b_cross_feed_*_to' do. Floats honour BS2B_FLAG_FLOAT.
+ */
+void bs2b_cross_feed_events_d( t_bs2bdp bs2bdp, double *sample, size_t n,
+	t_bs2b_event const *event, size_t count );
+
+void bs2b_cross_feed_events_f( t_bs2bdp bs2bdp, float *sample, size_t n,
+	t_bs2b_event const *event, size_t count );
+
+void bs2b_cross_feed_events_d_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n,
+	t_bs2b_event const *event, size_t count );
+
+void bs2b_cross_feed_events_f_to( t_bs2bdp bs2bdp,
+	float const *in, float *out, size_t n,
+	t_bs2b_event const *event, size_t count );
+
+/* 'bs2b_cross_feed_parallel_d*' crossfeeds 'n' stereo samples of native
+ * endian doubles in the layout of 'bs2b_cross_feed_d*' by up to
+ * 'threads' threads ( 0 - one per CPU ), for long buffers of offline
+ * renders. The buffer is split in parts of at least 65536 stereo
+ * samples. The first pass filters each part from zero state in
+ * parallel. The exact states before parts follow from the end states of
+ * the previous parts, as the filters are linear. The second pass adds
+ * the decaying response to them to the beginnings of parts. Output
+ * equals bs2b_cross_feed_d() within rounding ( about 1e-15 for full
+ * scale ). Posted levels are taken once at the start, without a ramp.
+ * BS2B_FLAG_DENORMAL_SAFE and BS2B_FLAG_LOOKAHEAD are honoured, silence
+ * is not skipped. Shorter buffers are crossfed by the calling thread.
+ */
+void bs2b_cross_feed_parallel_d( t_bs2bdp bs2bdp, double *sample, size_t n,
+	int threads );
+
+void bs2b_cross_feed_parallel_d_to( t_bs2bdp bs2bdp,
+	double const *in, double *out, size_t n, int threads );
+
+/* Allocates a batch of 'count' streams at default level and sample rate.
+ * Return NULL on error.
+ */
+t_bs2b_batchp bs2b_batch_open( size_t count );
+
+/* Close */
+void bs2b_batch_close( t_bs2b_batchp batch );
+
+/* Sets sample rate and crossfeed level of 'stream', the stream buffer is
+ * cleared if sample rate changes. Out of range values are replaced
+ * by defaults as by bs2b_configure().
+ */
+void bs2b_batch_configure( t_bs2b_batchp batch, size_t stream,
+	uint32_t srate, uint32_t level );
+
+/* Clear buffer of 'stream' */
+void bs2b_batch_clear( t_bs2b_batchp batch, size_t stream );
+
+/* Crossfeeds 'n' stereo samples of native endian floats of every stream
+ * of a batch in place. sample[k] points to samples of stream 'k' in the
+ * layout of bs2b_cross_feed_f(). Streams are filtered by the single
+ * precision engine, results are the same as of bs2b_cross_feed_f() with
+ * BS2B_FLAG_FLOAT of an instance per stream on the same kernel, except
+ * that denormals are flushed to zero during the call on SSE2 and later
+ * kernels as by BS2B_FLAG_DENORMAL_SAFE.
+ */
+void bs2b_batch_cross_feed_f( t_bs2b_batchp batch, float * const *sample,
+	size_t n );
+
 #ifdef __cplusplus
 }	/* extern "C" */
 #endif /* __cplusplus */
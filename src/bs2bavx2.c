@@ -0,0 +1,1129 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "bs2bkernel.h"
+
+#ifdef BS2B_HAVE_AVX2
+
+#include <string.h>
+#include <immintrin.h>
+
+#define AVX2 BS2B_TARGET( "avx2,fma" )
+
+/* Lowpass and highboost states of both channels share one register:
+ * lanes 0, 1 are lowpass states, lanes 2, 3 are highboost states
+ * of the first and second channel.
+ * The recurrence is a single fused multiply-add per stereo sample,
+ * so the result differs from the scalar cross_feed_d() within rounding.
+ */
+static AVX2 void cross_feed_d( t_bs2bdp bs2bdp,
+	double const *in, double *out, int n )
+{
+	__m256d a0, a1, b1, asis, lfs, x;
+	__m128d gain, lo, y;
+
+	if( n <= 0 ) return;
+
+	a0 = _mm256_setr_pd(
+		bs2bdp->a0_lo, bs2bdp->a0_lo, bs2bdp->a0_hi, bs2bdp->a0_hi );
+	a1 = _mm256_setr_pd( 0.0, 0.0, bs2bdp->a1_hi, bs2bdp->a1_hi );
+	b1 = _mm256_setr_pd(
+		bs2bdp->b1_lo, bs2bdp->b1_lo, bs2bdp->b1_hi, bs2bdp->b1_hi );
+	gain = _mm_set1_pd( bs2bdp->gain );
+
+	asis = _mm256_broadcast_pd( ( __m128d const * )bs2bdp->lfs.asis );
+	lfs  = _mm256_set_m128d(
+		_mm_loadu_pd( bs2bdp->lfs.hi ), _mm_loadu_pd( bs2bdp->lfs.lo ) );
+
+	while( n-- )
+	{
+		x = _mm256_broadcast_pd( ( __m128d const * )in );
+
+		/* Lowpass and highboost filters */
+		lfs = _mm256_fmadd_pd( b1, lfs,
+			_mm256_fmadd_pd( a1, asis, _mm256_mul_pd( a0, x ) ) );
+		asis = x;
+
+		/* Crossfeed, lowpassed channels are swapped */
+		lo = _mm256_castpd256_pd128( lfs );
+		y = _mm_add_pd(
+			_mm256_extractf128_pd( lfs, 1 ), _mm_shuffle_pd( lo, lo, 1 ) );
+
+		/* Bass boost cause allpass attenuation */
+		_mm_storeu_pd( out, _mm_mul_pd( y, gain ) );
+
+		in  += 2;
+		out += 2;
+	} /* while */
+
+	_mm_storeu_pd( bs2bdp->lfs.asis, _mm256_castpd256_pd128( asis ) );
+	_mm_storeu_pd( bs2bdp->lfs.lo, _mm256_castpd256_pd128( lfs ) );
+	_mm_storeu_pd( bs2bdp->lfs.hi, _mm256_extractf128_pd( lfs, 1 ) );
+} /* cross_feed_d() */
+
+/* Both lanes of a 128 bit half are one coefficient */
+#define PAIR_PD( v0, v1 ) _mm256_setr_pd( v0, v0, v1, v1 )
+
+/* Look-ahead by four stereo samples, two per register. A stereo sample
+ * 'k' of a step is computed from inputs 'x[ j ]' of the step up to 'k'
+ * and the state before the step:
+ *   lo[ k ] = a0 * b1^(k-j) * x[ j ] + b1^(k+1) * lo[ -1 ]
+ *   hi[ k ] = a0 * x[ k ] + ( a0 * b1 + a1 ) * b1^(k-j-1) * x[ j < k ]
+ *           + a1 * b1^k * x[ -1 ] + b1^(k+1) * hi[ -1 ]
+ * summed over 'j'. Only the last stereo sample is the next state,
+ * so the recurrence is one fused multiply-add and one permute
+ * per four stereo samples. Inputs are broadcast from memory.
+ */
+static AVX2 void cross_feed_ahead_d( t_bs2bdp bs2bdp,
+	double const *in, double *out, int n )
+{
+	double  lo[ 4 ], hi[ 4 ], as[ 4 ], plo[ 5 ], phi[ 5 ];
+	__m256d k0_lo, ka_lo, kb_lo, kc_lo, p1_lo, p2_lo;
+	__m256d k0_hi, ka_hi, kb_hi, kc_hi, s1_hi, s2_hi, p1_hi, p2_hi, gain;
+	__m256d asis, lfs_lo, lfs_hi, x1, x2, d0, d1, d2;
+	__m256d lo1, lo2, hi1, hi2;
+	int     i;
+
+	if( n <= 0 ) return;
+
+	/* Powers of poles and coefficients by distance in stereo samples */
+	plo[ 0 ] = phi[ 0 ] = 1.0;
+	for( i = 1; i < 5; i++ )
+	{
+		plo[ i ] = plo[ i - 1 ] * bs2bdp->b1_lo;
+		phi[ i ] = phi[ i - 1 ] * bs2bdp->b1_hi;
+	}
+	hi[ 0 ] = bs2bdp->a0_hi;
+	for( i = 0; i < 4; i++ )
+	{
+		lo[ i ] = bs2bdp->a0_lo * plo[ i ];
+		as[ i ] = bs2bdp->a1_hi * phi[ i ];
+		if( i > 0 )
+			hi[ i ] = ( bs2bdp->a0_hi * bs2bdp->b1_hi + bs2bdp->a1_hi ) *
+				phi[ i - 1 ];
+	}
+
+	k0_lo = _mm256_set1_pd( lo[ 0 ] );
+	ka_lo = PAIR_PD( 0.0, lo[ 1 ] );
+	kb_lo = PAIR_PD( lo[ 1 ], lo[ 2 ] );
+	kc_lo = PAIR_PD( lo[ 2 ], lo[ 3 ] );
+	p1_lo = PAIR_PD( plo[ 1 ], plo[ 2 ] );
+	p2_lo = PAIR_PD( plo[ 3 ], plo[ 4 ] );
+	k0_hi = _mm256_set1_pd( hi[ 0 ] );
+	ka_hi = PAIR_PD( 0.0, hi[ 1 ] );
+	kb_hi = PAIR_PD( hi[ 1 ], hi[ 2 ] );
+	kc_hi = PAIR_PD( hi[ 2 ], hi[ 3 ] );
+	s1_hi = PAIR_PD( as[ 0 ], as[ 1 ] );
+	s2_hi = PAIR_PD( as[ 2 ], as[ 3 ] );
+	p1_hi = PAIR_PD( phi[ 1 ], phi[ 2 ] );
+	p2_hi = PAIR_PD( phi[ 3 ], phi[ 4 ] );
+	gain  = _mm256_set1_pd( bs2bdp->gain );
+
+	/* States of both channels in both halves */
+	asis   = _mm256_broadcast_pd( ( __m128d const * )bs2bdp->lfs.asis );
+	lfs_lo = _mm256_broadcast_pd( ( __m128d const * )bs2bdp->lfs.lo );
+	lfs_hi = _mm256_broadcast_pd( ( __m128d const * )bs2bdp->lfs.hi );
+
+	for( i = n >> 2; i > 0; i-- )
+	{
+		x1  = _mm256_loadu_pd( in );
+		x2  = _mm256_loadu_pd( in + 4 );
+		d0 = _mm256_broadcast_pd( ( __m128d const * )in );
+		d1 = _mm256_broadcast_pd( ( __m128d const * )( in + 2 ) );
+		d2 = _mm256_broadcast_pd( ( __m128d const * )( in + 4 ) );
+
+		/* Lowpass filter */
+		lo1 = _mm256_fmadd_pd( p1_lo, lfs_lo,
+			_mm256_fmadd_pd( ka_lo, d0, _mm256_mul_pd( k0_lo, x1 ) ) );
+		lo2 = _mm256_fmadd_pd( p2_lo, lfs_lo,
+			_mm256_fmadd_pd( kc_lo, d0,
+			_mm256_fmadd_pd( kb_lo, d1,
+			_mm256_fmadd_pd( ka_lo, d2, _mm256_mul_pd( k0_lo, x2 ) ) ) ) );
+
+		/* Highboost filter */
+		hi1 = _mm256_fmadd_pd( p1_hi, lfs_hi,
+			_mm256_fmadd_pd( s1_hi, asis,
+			_mm256_fmadd_pd( ka_hi, d0, _mm256_mul_pd( k0_hi, x1 ) ) ) );
+		hi2 = _mm256_fmadd_pd( p2_hi, lfs_hi,
+			_mm256_fmadd_pd( s2_hi, asis,
+			_mm256_fmadd_pd( kc_hi, d0,
+			_mm256_fmadd_pd( kb_hi, d1,
+			_mm256_fmadd_pd( ka_hi, d2, _mm256_mul_pd( k0_hi, x2 ) ) ) ) ) );
+
+		/* The last stereo sample is the next state */
+		asis   = _mm256_permute2f128_pd( x2, x2, 0x11 );
+		lfs_lo = _mm256_permute2f128_pd( lo2, lo2, 0x11 );
+		lfs_hi = _mm256_permute2f128_pd( hi2, hi2, 0x11 );
+
+		/* Crossfeed, lowpassed channels are swapped, and
+		 * bass boost cause allpass attenuation
+		 */
+		_mm256_storeu_pd( out, _mm256_mul_pd(
+			_mm256_add_pd( hi1, _mm256_permute_pd( lo1, 5 ) ), gain ) );
+		_mm256_storeu_pd( out + 4, _mm256_mul_pd(
+			_mm256_add_pd( hi2, _mm256_permute_pd( lo2, 5 ) ), gain ) );
+
+		in  += 8;
+		out += 8;
+	} /* for */
+
+	_mm_storeu_pd( bs2bdp->lfs.asis, _mm256_castpd256_pd128( asis ) );
+	_mm_storeu_pd( bs2bdp->lfs.lo, _mm256_castpd256_pd128( lfs_lo ) );
+	_mm_storeu_pd( bs2bdp->lfs.hi, _mm256_castpd256_pd128( lfs_hi ) );
+
+	/* Up to three last stereo samples */
+	cross_feed_d( bs2bdp, in, out, n & 3 );
+} /* cross_feed_ahead_d() */
+
+/* Single precision variant of the same layout in a 128 bit register.
+ * The result differs from the scalar cross_feed_f() within rounding.
+ */
+static AVX2 void cross_feed_f( t_bs2bdp bs2bdp,
+	float const *in, float *out, int n )
+{
+	__m128 a0, a1, b1, gain, asis, lfs, x, y;
+
+	if( n <= 0 ) return;
+
+	a0 = _mm_setr_ps(
+		bs2bdp->f.a0_lo, bs2bdp->f.a0_lo, bs2bdp->f.a0_hi, bs2bdp->f.a0_hi );
+	a1 = _mm_setr_ps( 0.0f, 0.0f, bs2bdp->f.a1_hi, bs2bdp->f.a1_hi );
+	b1 = _mm_setr_ps(
+		bs2bdp->f.b1_lo, bs2bdp->f.b1_lo, bs2bdp->f.b1_hi, bs2bdp->f.b1_hi );
+	gain = _mm_set1_ps( bs2bdp->f.gain );
+
+	asis = _mm_setr_ps( bs2bdp->lfsf.asis[ 0 ], bs2bdp->lfsf.asis[ 1 ],
+		bs2bdp->lfsf.asis[ 0 ], bs2bdp->lfsf.asis[ 1 ] );
+	lfs  = _mm_setr_ps( bs2bdp->lfsf.lo[ 0 ], bs2bdp->lfsf.lo[ 1 ],
+		bs2bdp->lfsf.hi[ 0 ], bs2bdp->lfsf.hi[ 1 ] );
+
+	while( n-- )
+	{
+		x = _mm_castpd_ps( _mm_loaddup_pd( ( double const * )in ) );
+
+		/* Lowpass and highboost filters */
+		lfs = _mm_fmadd_ps( b1, lfs,
+			_mm_fmadd_ps( a1, asis, _mm_mul_ps( a0, x ) ) );
+		asis = x;
+
+		/* Crossfeed, lowpassed channels are swapped */
+		y = _mm_add_ps( _mm_movehl_ps( lfs, lfs ),
+			_mm_permute_ps( lfs, _MM_SHUFFLE( 3, 2, 0, 1 ) ) );
+
+		/* Bass boost cause allpass attenuation */
+		_mm_storel_pi( ( __m64 * )out, _mm_mul_ps( y, gain ) );
+
+		in  += 2;
+		out += 2;
+	} /* while */
+
+	_mm_storel_pi( ( __m64 * )bs2bdp->lfsf.asis, asis );
+	_mm_storel_pi( ( __m64 * )bs2bdp->lfsf.lo, lfs );
+	_mm_storeh_pi( ( __m64 * )bs2bdp->lfsf.hi, lfs );
+} /* cross_feed_f() */
+
+/* Transposes 8 x 8 floats in place. A macro rather than a function, so
+ * that the rows stay in registers.
+ */
+#define TRANSPOSE8( t ) \
+{ \
+	__m256 a0, a1, a2, a3, a4, a5, a6, a7; \
+	__m256 b0, b1, b2, b3, b4, b5, b6, b7; \
+\
+	a0 = _mm256_unpacklo_ps( t[ 0 ], t[ 1 ] ); \
+	a1 = _mm256_unpackhi_ps( t[ 0 ], t[ 1 ] ); \
+	a2 = _mm256_unpacklo_ps( t[ 2 ], t[ 3 ] ); \
+	a3 = _mm256_unpackhi_ps( t[ 2 ], t[ 3 ] ); \
+	a4 = _mm256_unpacklo_ps( t[ 4 ], t[ 5 ] ); \
+	a5 = _mm256_unpackhi_ps( t[ 4 ], t[ 5 ] ); \
+	a6 = _mm256_unpacklo_ps( t[ 6 ], t[ 7 ] ); \
+	a7 = _mm256_unpackhi_ps( t[ 6 ], t[ 7 ] ); \
+\
+	b0 = _mm256_shuffle_ps( a0, a2, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b1 = _mm256_shuffle_ps( a0, a2, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+	b2 = _mm256_shuffle_ps( a1, a3, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b3 = _mm256_shuffle_ps( a1, a3, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+	b4 = _mm256_shuffle_ps( a4, a6, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b5 = _mm256_shuffle_ps( a4, a6, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+	b6 = _mm256_shuffle_ps( a5, a7, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b7 = _mm256_shuffle_ps( a5, a7, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+\
+	t[ 0 ] = _mm256_permute2f128_ps( b0, b4, 0x20 ); \
+	t[ 1 ] = _mm256_permute2f128_ps( b1, b5, 0x20 ); \
+	t[ 2 ] = _mm256_permute2f128_ps( b2, b6, 0x20 ); \
+	t[ 3 ] = _mm256_permute2f128_ps( b3, b7, 0x20 ); \
+	t[ 4 ] = _mm256_permute2f128_ps( b0, b4, 0x31 ); \
+	t[ 5 ] = _mm256_permute2f128_ps( b1, b5, 0x31 ); \
+	t[ 6 ] = _mm256_permute2f128_ps( b2, b6, 0x31 ); \
+	t[ 7 ] = _mm256_permute2f128_ps( b3, b7, 0x31 ); \
+}
+
+/* One stereo sample of eight streams in 'x0', 'x1' through the filters */
+#define BATCH_STEP( x0, x1 ) \
+	lo0 = _mm256_fmadd_ps( b1_lo, lo0, _mm256_mul_ps( a0_lo, x0 ) ); \
+	lo1 = _mm256_fmadd_ps( b1_lo, lo1, _mm256_mul_ps( a0_lo, x1 ) ); \
+	hi0 = _mm256_fmadd_ps( b1_hi, hi0, \
+		_mm256_fmadd_ps( a1_hi, asis0, _mm256_mul_ps( a0_hi, x0 ) ) ); \
+	hi1 = _mm256_fmadd_ps( b1_hi, hi1, \
+		_mm256_fmadd_ps( a1_hi, asis1, _mm256_mul_ps( a0_hi, x1 ) ) ); \
+	asis0 = x0; \
+	asis1 = x1; \
+	x0 = _mm256_mul_ps( _mm256_add_ps( hi0, lo1 ), gain ); \
+	x1 = _mm256_mul_ps( _mm256_add_ps( hi1, lo0 ), gain )
+
+/* Streams of a batch in lanes, eight at a time. The order of fused
+ * multiply-adds is the one of cross_feed_f() above, so the result is
+ * bit-exact with it.
+ */
+static AVX2 void cross_feed_batch_f( t_bs2b_batchp batch, size_t first,
+	float * const *sample, int n )
+{
+	__m256 a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain;
+	__m256 asis0, asis1, lo0, lo1, hi0, hi1, x0, x1;
+	__m256 t[ 8 ];
+	float  l[ 8 ], r[ 8 ];
+	size_t k;
+	int    i, j;
+
+	for( k = 0; k < BS2B_BATCH_LANES; k += 8 )
+	{
+		a0_lo = _mm256_loadu_ps( batch->a0_lo + first + k );
+		b1_lo = _mm256_loadu_ps( batch->b1_lo + first + k );
+		a0_hi = _mm256_loadu_ps( batch->a0_hi + first + k );
+		a1_hi = _mm256_loadu_ps( batch->a1_hi + first + k );
+		b1_hi = _mm256_loadu_ps( batch->b1_hi + first + k );
+		gain  = _mm256_loadu_ps( batch->gain + first + k );
+
+		asis0 = _mm256_loadu_ps( batch->asis[ 0 ] + first + k );
+		asis1 = _mm256_loadu_ps( batch->asis[ 1 ] + first + k );
+		lo0   = _mm256_loadu_ps( batch->lo[ 0 ] + first + k );
+		lo1   = _mm256_loadu_ps( batch->lo[ 1 ] + first + k );
+		hi0   = _mm256_loadu_ps( batch->hi[ 0 ] + first + k );
+		hi1   = _mm256_loadu_ps( batch->hi[ 1 ] + first + k );
+
+		/* Four stereo samples of eight streams are transposed to lanes */
+		for( i = 0; i + 4 <= n; i += 4 )
+		{
+			for( j = 0; j < 8; j++ )
+				t[ j ] = _mm256_loadu_ps( sample[ k + j ] + i * 2 );
+			TRANSPOSE8( t )
+
+			BATCH_STEP( t[ 0 ], t[ 1 ] );
+			BATCH_STEP( t[ 2 ], t[ 3 ] );
+			BATCH_STEP( t[ 4 ], t[ 5 ] );
+			BATCH_STEP( t[ 6 ], t[ 7 ] );
+
+			TRANSPOSE8( t )
+			for( j = 0; j < 8; j++ )
+				_mm256_storeu_ps( sample[ k + j ] + i * 2, t[ j ] );
+		} /* for */
+
+		/* Rest of stereo samples one by one */
+		for( ; i < n; i++ )
+		{
+			for( j = 0; j < 8; j++ )
+			{
+				l[ j ] = sample[ k + j ][ i * 2 ];
+				r[ j ] = sample[ k + j ][ i * 2 + 1 ];
+			}
+
+			x0 = _mm256_loadu_ps( l );
+			x1 = _mm256_loadu_ps( r );
+			BATCH_STEP( x0, x1 );
+			_mm256_storeu_ps( l, x0 );
+			_mm256_storeu_ps( r, x1 );
+
+			for( j = 0; j < 8; j++ )
+			{
+				sample[ k + j ][ i * 2 ]     = l[ j ];
+				sample[ k + j ][ i * 2 + 1 ] = r[ j ];
+			}
+		} /* for */
+
+		_mm256_storeu_ps( batch->asis[ 0 ] + first + k, asis0 );
+		_mm256_storeu_ps( batch->asis[ 1 ] + first + k, asis1 );
+		_mm256_storeu_ps( batch->lo[ 0 ] + first + k, lo0 );
+		_mm256_storeu_ps( batch->lo[ 1 ] + first + k, lo1 );
+		_mm256_storeu_ps( batch->hi[ 0 ] + first + k, hi0 );
+		_mm256_storeu_ps( batch->hi[ 1 ] + first + k, hi1 );
+	} /* for */
+} /* cross_feed_batch_f() */
+
+/* Fixed-point engine in the same layout of 64 bit lanes. Q30 samples and
+ * coefficients are multiplied to 64 bit and rounded back to Q30 by
+ * a logical shift: only the low 32 bits of a lane are used further.
+ * The result is bit-exact with the scalar cross_feed_q().
+ */
+static AVX2 void cross_feed_q( t_bs2bdp bs2bdp,
+	void const *in, void *out, int n, int s16 )
+{
+	int16_t const *x16 = ( int16_t const * )in;
+	int32_t const *x32 = ( int32_t const * )in;
+	int16_t *y16 = ( int16_t * )out;
+	int32_t *y32 = ( int32_t * )out;
+	__m256i a0, a1, b1, gain, round, asis, lfs, x;
+	__m128i y;
+	int     v;
+
+	if( n <= 0 ) return;
+
+	a0 = _mm256_setr_epi64x(
+		bs2bdp->q.a0_lo, bs2bdp->q.a0_lo, bs2bdp->q.a0_hi, bs2bdp->q.a0_hi );
+	a1 = _mm256_setr_epi64x( 0, 0, bs2bdp->q.a1_hi, bs2bdp->q.a1_hi );
+	b1 = _mm256_setr_epi64x(
+		bs2bdp->q.b1_lo, bs2bdp->q.b1_lo, bs2bdp->q.b1_hi, bs2bdp->q.b1_hi );
+	gain  = _mm256_set1_epi64x( bs2bdp->q.gain );
+	round = _mm256_set1_epi64x( 1 << 29 );
+
+	asis = _mm256_setr_epi64x( bs2bdp->lfsq.asis[ 0 ], bs2bdp->lfsq.asis[ 1 ],
+		bs2bdp->lfsq.asis[ 0 ], bs2bdp->lfsq.asis[ 1 ] );
+	lfs  = _mm256_setr_epi64x( bs2bdp->lfsq.lo[ 0 ], bs2bdp->lfsq.lo[ 1 ],
+		bs2bdp->lfsq.hi[ 0 ], bs2bdp->lfsq.hi[ 1 ] );
+
+	while( n-- )
+	{
+		if( s16 )
+		{
+			memcpy( &v, x16, sizeof( v ) );
+			x = _mm256_slli_epi64(
+				_mm256_cvtepi16_epi64( _mm_set1_epi32( v ) ), 15 );
+			x16 += 2;
+		}
+		else
+		{
+			y = _mm_srai_epi32( _mm_loadl_epi64( ( __m128i const * )x32 ), 1 );
+			x = _mm256_cvtepi32_epi64( _mm_unpacklo_epi64( y, y ) );
+			x32 += 2;
+		}
+
+		/* Lowpass and highboost filters, the buffer term is added last
+		 * to keep the recurrence short
+		 */
+		lfs = _mm256_srli_epi64( _mm256_add_epi64( _mm256_mul_epi32( b1, lfs ),
+			_mm256_add_epi64( _mm256_add_epi64( _mm256_mul_epi32( a0, x ),
+			_mm256_mul_epi32( a1, asis ) ), round ) ), 30 );
+		asis = x;
+
+		/* Crossfeed, lowpassed channels are swapped into high lanes,
+		 * and bass boost cause allpass attenuation
+		 */
+		x = _mm256_add_epi32( lfs,
+			_mm256_permute4x64_epi64( lfs, _MM_SHUFFLE( 0, 1, 0, 1 ) ) );
+		x = _mm256_srli_epi64( _mm256_add_epi64(
+			_mm256_mul_epi32( x, gain ), round ), 30 );
+		y = _mm_shuffle_epi32(
+			_mm256_extracti128_si256( x, 1 ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+		if( s16 )
+		{
+			/* Truncation toward zero, clipping by saturation */
+			y = _mm_srai_epi32( _mm_add_epi32( y, _mm_and_si128(
+				_mm_srai_epi32( y, 31 ), _mm_set1_epi32( 0x7fff ) ) ), 15 );
+			v = _mm_cvtsi128_si32( _mm_packs_epi32( y, y ) );
+			memcpy( y16, &v, sizeof( v ) );
+			y16 += 2;
+		}
+		else
+		{
+			/* Clipping of overloaded samples */
+			y = _mm_max_epi32( _mm_min_epi32( y,
+				_mm_set1_epi32( 1073741823 ) ), _mm_set1_epi32( -1073741824 ) );
+			_mm_storel_epi64( ( __m128i * )y32, _mm_slli_epi32( y, 1 ) );
+			y32 += 2;
+		}
+	} /* while */
+
+	bs2bdp->lfsq.asis[ 0 ] = _mm256_extract_epi32( asis, 0 );
+	bs2bdp->lfsq.asis[ 1 ] = _mm256_extract_epi32( asis, 2 );
+	bs2bdp->lfsq.lo[ 0 ]   = _mm256_extract_epi32( lfs, 0 );
+	bs2bdp->lfsq.lo[ 1 ]   = _mm256_extract_epi32( lfs, 2 );
+	bs2bdp->lfsq.hi[ 0 ]   = _mm256_extract_epi32( lfs, 4 );
+	bs2bdp->lfsq.hi[ 1 ]   = _mm256_extract_epi32( lfs, 6 );
+} /* cross_feed_q() */
+
+static AVX2 void cross_feed_s16q( t_bs2bdp bs2bdp,
+	int16_t const *in, int16_t *out, int n )
+{
+	cross_feed_q( bs2bdp, in, out, n, 1 );
+} /* cross_feed_s16q() */
+
+static AVX2 void cross_feed_s32q( t_bs2bdp bs2bdp,
+	int32_t const *in, int32_t *out, int n )
+{
+	cross_feed_q( bs2bdp, in, out, n, 0 );
+} /* cross_feed_s32q() */
+
+static AVX2 void decode_f( void const *in, double *out, int n )
+{
+	float const *x = ( float const * )in;
+
+	for( ; n >= 8; n -= 8, x += 8, out += 8 )
+	{
+		_mm256_storeu_pd( out, _mm256_cvtps_pd( _mm_loadu_ps( x ) ) );
+		_mm256_storeu_pd( out + 4, _mm256_cvtps_pd( _mm_loadu_ps( x + 4 ) ) );
+	}
+
+	while( n-- )
+		*out++ = ( double )*x++;
+} /* decode_f() */
+
+static AVX2 void encode_f( double const *in, void *out, int n )
+{
+	float *y = ( float * )out;
+
+	for( ; n >= 8; n -= 8, in += 8, y += 8 )
+	{
+		_mm_storeu_ps( y, _mm256_cvtpd_ps( _mm256_loadu_pd( in ) ) );
+		_mm_storeu_ps( y + 4, _mm256_cvtpd_ps( _mm256_loadu_pd( in + 4 ) ) );
+	}
+
+	/* 256 bit sources of 128 bit results leave the upper state dirty
+	 * without the compiler noticing, which slows down SSE code after
+	 * return several times over
+	 */
+	_mm256_zeroupper();
+
+	while( n-- )
+		*y++ = ( float )*in++;
+} /* encode_f() */
+
+/* Planar channels */
+
+static AVX2 void zip_d( double const *left, double const *right,
+	double *out, int n )
+{
+	__m256d l, r, lo, hi;
+
+	for( ; n >= 4; n -= 4, left += 4, right += 4, out += 8 )
+	{
+		l  = _mm256_loadu_pd( left );
+		r  = _mm256_loadu_pd( right );
+		lo = _mm256_unpacklo_pd( l, r );
+		hi = _mm256_unpackhi_pd( l, r );
+		_mm256_storeu_pd( out, _mm256_permute2f128_pd( lo, hi, 0x20 ) );
+		_mm256_storeu_pd( out + 4, _mm256_permute2f128_pd( lo, hi, 0x31 ) );
+	}
+
+	while( n-- )
+	{
+		*out++ = *left++;
+		*out++ = *right++;
+	}
+} /* zip_d() */
+
+static AVX2 void zip_f( float const *left, float const *right,
+	float *out, int n )
+{
+	__m256 l, r, lo, hi;
+
+	for( ; n >= 8; n -= 8, left += 8, right += 8, out += 16 )
+	{
+		l  = _mm256_loadu_ps( left );
+		r  = _mm256_loadu_ps( right );
+		lo = _mm256_unpacklo_ps( l, r );
+		hi = _mm256_unpackhi_ps( l, r );
+		_mm256_storeu_ps( out, _mm256_permute2f128_ps( lo, hi, 0x20 ) );
+		_mm256_storeu_ps( out + 8, _mm256_permute2f128_ps( lo, hi, 0x31 ) );
+	}
+
+	while( n-- )
+	{
+		*out++ = *left++;
+		*out++ = *right++;
+	}
+} /* zip_f() */
+
+static AVX2 void unzip_d( double const *in, double *left, double *right,
+	int n )
+{
+	__m256d a, b, lo, hi;
+
+	for( ; n >= 4; n -= 4, in += 8, left += 4, right += 4 )
+	{
+		a  = _mm256_loadu_pd( in );
+		b  = _mm256_loadu_pd( in + 4 );
+		lo = _mm256_permute2f128_pd( a, b, 0x20 );
+		hi = _mm256_permute2f128_pd( a, b, 0x31 );
+		_mm256_storeu_pd( left, _mm256_unpacklo_pd( lo, hi ) );
+		_mm256_storeu_pd( right, _mm256_unpackhi_pd( lo, hi ) );
+	}
+
+	while( n-- )
+	{
+		*left++  = *in++;
+		*right++ = *in++;
+	}
+} /* unzip_d() */
+
+static AVX2 void unzip_f( float const *in, float *left, float *right, int n )
+{
+	__m256 a, b, lo, hi;
+
+	for( ; n >= 8; n -= 8, in += 16, left += 8, right += 8 )
+	{
+		a  = _mm256_loadu_ps( in );
+		b  = _mm256_loadu_ps( in + 8 );
+		lo = _mm256_permute2f128_ps( a, b, 0x20 );
+		hi = _mm256_permute2f128_ps( a, b, 0x31 );
+		_mm256_storeu_ps( left,
+			_mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+		_mm256_storeu_ps( right,
+			_mm256_shuffle_ps( lo, hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+	}
+
+	while( n-- )
+	{
+		*left++  = *in++;
+		*right++ = *in++;
+	}
+} /* unzip_f() */
+
+/* Byte shuffles of 16, 32 and 64 bit lanes */
+#define SWAP16 _mm_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, \
+	9, 8, 11, 10, 13, 12, 15, 14 )
+#define SWAP32 _mm_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, \
+	11, 10, 9, 8, 15, 14, 13, 12 )
+#define SWAP64 _mm_setr_epi8( 7, 6, 5, 4, 3, 2, 1, 0, \
+	15, 14, 13, 12, 11, 10, 9, 8 )
+
+/* Byte swapped doubles and floats */
+
+static AVX2 void decode_dx( void const *in, double *out, int n )
+{
+	double const *x = ( double const * )in;
+	__m256i s = _mm256_broadcastsi128_si256( SWAP64 );
+
+	for( ; n >= 4; n -= 4, x += 4, out += 4 )
+		_mm256_storeu_pd( out, _mm256_castsi256_pd( _mm256_shuffle_epi8(
+			_mm256_loadu_si256( ( __m256i const * )x ), s ) ) );
+
+	for( ; n > 0; n--, x++, out++ )
+		_mm_storel_pd( out, _mm_castsi128_pd( _mm_shuffle_epi8(
+			_mm_loadl_epi64( ( __m128i const * )x ), SWAP64 ) ) );
+} /* decode_dx() */
+
+static AVX2 void encode_dx( double const *in, void *out, int n )
+{
+	double *y = ( double * )out;
+	__m256i s = _mm256_broadcastsi128_si256( SWAP64 );
+
+	for( ; n >= 4; n -= 4, in += 4, y += 4 )
+		_mm256_storeu_si256( ( __m256i * )y, _mm256_shuffle_epi8(
+			_mm256_castpd_si256( _mm256_loadu_pd( in ) ), s ) );
+
+	for( ; n > 0; n--, in++, y++ )
+		_mm_storel_epi64( ( __m128i * )y, _mm_shuffle_epi8(
+			_mm_castpd_si128( _mm_load_sd( in ) ), SWAP64 ) );
+} /* encode_dx() */
+
+static AVX2 void swap32( void const *in, void *out, int n )
+{
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t *y = ( uint32_t * )out;
+	__m256i s = _mm256_broadcastsi128_si256( SWAP32 );
+
+	for( ; n >= 8; n -= 8, x += 8, y += 8 )
+		_mm256_storeu_si256( ( __m256i * )y, _mm256_shuffle_epi8(
+			_mm256_loadu_si256( ( __m256i const * )x ), s ) );
+
+	while( n-- )
+	{
+		*y++ = BS2B_SWAP32( *x );
+		x++;
+	}
+} /* swap32() */
+
+static AVX2 void decode_fx( void const *in, double *out, int n )
+{
+	float const *x = ( float const * )in;
+	uint32_t y[ 4 ];
+
+	for( ; n >= 4; n -= 4, x += 4, out += 4 )
+		_mm256_storeu_pd( out, _mm256_cvtps_pd( _mm_castsi128_ps(
+			_mm_shuffle_epi8( _mm_loadu_si128( ( __m128i const * )x ),
+			SWAP32 ) ) ) );
+
+	if( n > 0 )
+	{
+		swap32( x, y, n );
+		decode_f( y, out, n );
+	}
+} /* decode_fx() */
+
+static AVX2 void encode_fx( double const *in, void *out, int n )
+{
+	float *y = ( float * )out;
+	uint32_t x[ 4 ];
+
+	for( ; n >= 4; n -= 4, in += 4, y += 4 )
+		_mm_storeu_si128( ( __m128i * )y, _mm_shuffle_epi8( _mm_castps_si128(
+			_mm256_cvtpd_ps( _mm256_loadu_pd( in ) ) ), SWAP32 ) );
+
+	_mm256_zeroupper();
+
+	if( n > 0 )
+	{
+		encode_f( in, x, n );
+		swap32( x, y, n );
+	}
+} /* encode_fx() */
+
+/* Integer codecs. Unsigned formats are biased to signed ones by XOR.
+ * 8 and 16 bit samples are clipped by saturating packs: a crossfeed
+ * of these formats never gets out of 32 bit integer range.
+ */
+
+#define MAX_INT32_VALUE  2147483647.0
+#define MIN_INT32_VALUE -2147483648.0
+
+/* Converts 8 32 bit integers to doubles */
+static AVX2 void cvt8( __m256i v, double *out )
+{
+	_mm256_storeu_pd( out, _mm256_cvtepi32_pd( _mm256_castsi256_si128( v ) ) );
+	_mm256_storeu_pd( out + 4,
+		_mm256_cvtepi32_pd( _mm256_extracti128_si256( v, 1 ) ) );
+} /* cvt8() */
+
+/* Truncates 8 doubles to 32 bit integers and packs them to 16 bits */
+static AVX2 __m128i cvtt8_packs( double const *in )
+{
+	return _mm_packs_epi32(
+		_mm256_cvttpd_epi32( _mm256_loadu_pd( in ) ),
+		_mm256_cvttpd_epi32( _mm256_loadu_pd( in + 4 ) ) );
+} /* cvtt8_packs() */
+
+static AVX2 void decode_32( void const *in, double *out, int n,
+	uint32_t bias, int swap )
+{
+	uint32_t const *x = ( uint32_t const * )in;
+	__m256i b = _mm256_set1_epi32( ( int )bias ), v;
+	__m256i s = _mm256_broadcastsi128_si256( SWAP32 );
+	uint32_t y;
+
+	for( ; n >= 8; n -= 8, x += 8, out += 8 )
+	{
+		v = _mm256_loadu_si256( ( __m256i const * )x );
+		if( swap ) v = _mm256_shuffle_epi8( v, s );
+		cvt8( _mm256_xor_si256( v, b ), out );
+	}
+
+	while( n-- )
+	{
+		y = *x++;
+		if( swap ) y = BS2B_SWAP32( y );
+		*out++ = ( double )( int32_t )( y ^ bias );
+	}
+} /* decode_32() */
+
+static AVX2 void encode_32( double const *in, void *out, int n,
+	uint32_t bias, int swap )
+{
+	uint32_t *y = ( uint32_t * )out;
+	__m128i b = _mm_set1_epi32( ( int )bias ), v;
+	__m256d max = _mm256_set1_pd( MAX_INT32_VALUE );
+	__m256d min = _mm256_set1_pd( MIN_INT32_VALUE );
+	double  x;
+
+	for( ; n >= 4; n -= 4, in += 4, y += 4 )
+	{
+		v = _mm_xor_si128( _mm256_cvttpd_epi32(
+			_mm256_min_pd( _mm256_max_pd( _mm256_loadu_pd( in ), min ), max ) ),
+			b );
+		if( swap ) v = _mm_shuffle_epi8( v, SWAP32 );
+		_mm_storeu_si128( ( __m128i * )y, v );
+	}
+
+	while( n-- )
+	{
+		x = *in++;
+
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT32_VALUE ) x = MAX_INT32_VALUE;
+		if( x < MIN_INT32_VALUE ) x = MIN_INT32_VALUE;
+
+		*y = ( uint32_t )( int32_t )x ^ bias;
+		if( swap ) *y = BS2B_SWAP32( *y );
+		y++;
+	}
+} /* encode_32() */
+
+static AVX2 void decode_16( void const *in, double *out, int n,
+	uint16_t bias, int swap )
+{
+	uint16_t const *x = ( uint16_t const * )in;
+	__m128i b = _mm_set1_epi16( ( short )bias ), v;
+	uint16_t y;
+
+	for( ; n >= 8; n -= 8, x += 8, out += 8 )
+	{
+		v = _mm_loadu_si128( ( __m128i const * )x );
+		if( swap ) v = _mm_shuffle_epi8( v, SWAP16 );
+		cvt8( _mm256_cvtepi16_epi32( _mm_xor_si128( v, b ) ), out );
+	}
+
+	while( n-- )
+	{
+		y = *x++;
+		if( swap ) y = BS2B_SWAP16( y );
+		*out++ = ( double )( int16_t )( y ^ bias );
+	}
+} /* decode_16() */
+
+static AVX2 void encode_16( double const *in, void *out, int n,
+	uint16_t bias, int swap )
+{
+	uint16_t *y = ( uint16_t * )out;
+	__m128i b = _mm_set1_epi16( ( short )bias ), v;
+	double  x;
+
+	for( ; n >= 8; n -= 8, in += 8, y += 8 )
+	{
+		v = _mm_xor_si128( cvtt8_packs( in ), b );
+		if( swap ) v = _mm_shuffle_epi8( v, SWAP16 );
+		_mm_storeu_si128( ( __m128i * )y, v );
+	}
+
+	_mm256_zeroupper();
+
+	while( n-- )
+	{
+		x = *in++;
+
+		/* Clipping of overloaded samples */
+		if( x > 32767.0 ) x = 32767.0;
+		if( x < -32768.0 ) x = -32768.0;
+
+		*y = ( uint16_t )( ( int16_t )x ^ bias );
+		if( swap ) *y = BS2B_SWAP16( *y );
+		y++;
+	}
+} /* encode_16() */
+
+static AVX2 void decode_8( void const *in, double *out, int n, uint8_t bias )
+{
+	uint8_t const *x = ( uint8_t const * )in;
+	__m128i b = _mm_set1_epi8( ( char )bias );
+
+	for( ; n >= 8; n -= 8, x += 8, out += 8 )
+		cvt8( _mm256_cvtepi8_epi32( _mm_xor_si128(
+			_mm_loadl_epi64( ( __m128i const * )x ), b ) ), out );
+
+	while( n-- )
+		*out++ = ( double )( int8_t )( *x++ ^ bias );
+} /* decode_8() */
+
+static AVX2 void encode_8( double const *in, void *out, int n, uint8_t bias )
+{
+	uint8_t *y = ( uint8_t * )out;
+	__m128i b = _mm_set1_epi8( ( char )bias ), v;
+	double  x;
+
+	for( ; n >= 8; n -= 8, in += 8, y += 8 )
+	{
+		v = cvtt8_packs( in );
+		_mm_storel_epi64( ( __m128i * )y,
+			_mm_xor_si128( _mm_packs_epi16( v, v ), b ) );
+	}
+
+	_mm256_zeroupper();
+
+	while( n-- )
+	{
+		x = *in++;
+
+		/* Clipping of overloaded samples */
+		if( x > 127.0 ) x = 127.0;
+		if( x < -128.0 ) x = -128.0;
+
+		*y++ = ( uint8_t )( ( int8_t )x ^ bias );
+	}
+} /* encode_8() */
+
+static AVX2 void decode_s32( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0, 0 );
+} /* decode_s32() */
+
+static AVX2 void encode_s32( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0, 0 );
+} /* encode_s32() */
+
+static AVX2 void decode_s32x( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0, 1 );
+} /* decode_s32x() */
+
+static AVX2 void encode_s32x( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0, 1 );
+} /* encode_s32x() */
+
+static AVX2 void decode_u32( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0x80000000, 0 );
+} /* decode_u32() */
+
+static AVX2 void encode_u32( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0x80000000, 0 );
+} /* encode_u32() */
+
+static AVX2 void decode_u32x( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0x80000000, 1 );
+} /* decode_u32x() */
+
+static AVX2 void encode_u32x( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0x80000000, 1 );
+} /* encode_u32x() */
+
+static AVX2 void decode_s16( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0, 0 );
+} /* decode_s16() */
+
+static AVX2 void encode_s16( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0, 0 );
+} /* encode_s16() */
+
+static AVX2 void decode_s16x( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0, 1 );
+} /* decode_s16x() */
+
+static AVX2 void encode_s16x( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0, 1 );
+} /* encode_s16x() */
+
+static AVX2 void decode_u16( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0x8000, 0 );
+} /* decode_u16() */
+
+static AVX2 void encode_u16( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0x8000, 0 );
+} /* encode_u16() */
+
+static AVX2 void decode_u16x( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0x8000, 1 );
+} /* decode_u16x() */
+
+static AVX2 void encode_u16x( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0x8000, 1 );
+} /* encode_u16x() */
+
+static AVX2 void decode_s8( void const *in, double *out, int n )
+{
+	decode_8( in, out, n, 0 );
+} /* decode_s8() */
+
+static AVX2 void encode_s8( double const *in, void *out, int n )
+{
+	encode_8( in, out, n, 0 );
+} /* encode_s8() */
+
+static AVX2 void decode_u8( void const *in, double *out, int n )
+{
+	decode_8( in, out, n, 0x80 );
+} /* decode_u8() */
+
+static AVX2 void encode_u8( double const *in, void *out, int n )
+{
+	encode_8( in, out, n, 0x80 );
+} /* encode_u8() */
+
+/* 24 bit codecs. Eight packed samples are moved by a masked load or
+ * store of six 32 bit words, spread to or gathered from 12 bytes of both
+ * 128 bit lanes by a word permutation and the bytes are rearranged by
+ * one byte shuffle. Samples are unpacked to high 24 bits of 32 bit lanes
+ * and sign extended by an arithmetic shift.
+ */
+
+#define MAX_INT24_VALUE     8388607.0
+#define MIN_INT24_VALUE    -8388608.0
+
+/* Unpacks 8 24 bit samples of 'x' to 32 bit integers */
+static AVX2 __m256i unpack24( void const *x, int swap )
+{
+	__m256i v = _mm256_maskload_epi32( ( int const * )x,
+		_mm256_setr_epi32( -1, -1, -1, -1, -1, -1, 0, 0 ) );
+
+	v = _mm256_permutevar8x32_epi32( v,
+		_mm256_setr_epi32( 0, 1, 2, 2, 3, 4, 5, 5 ) );
+
+	return _mm256_shuffle_epi8( v, swap ?
+		_mm256_broadcastsi128_si256( _mm_setr_epi8(
+			-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9 ) ) :
+		_mm256_broadcastsi128_si256( _mm_setr_epi8(
+			-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 ) ) );
+} /* unpack24() */
+
+/* Packs low 24 bits of 8 32 bit integers to 'y' */
+static AVX2 void pack24( __m256i v, void *y, int swap )
+{
+	v = _mm256_shuffle_epi8( v, swap ?
+		_mm256_broadcastsi128_si256( _mm_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) ) :
+		_mm256_broadcastsi128_si256( _mm_setr_epi8(
+			0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 ) ) );
+
+	v = _mm256_permutevar8x32_epi32( v,
+		_mm256_setr_epi32( 0, 1, 2, 4, 5, 6, 3, 7 ) );
+
+	_mm256_maskstore_epi32( ( int * )y,
+		_mm256_setr_epi32( -1, -1, -1, -1, -1, -1, 0, 0 ), v );
+} /* pack24() */
+
+/* Unsigned samples are biased by XOR of 'bias' to unpacked words. */
+static AVX2 void decode_24( void const *in, double *out, int n,
+	uint32_t bias, int swap )
+{
+	uint8_t const *x = ( uint8_t const * )in;
+	__m256i b = _mm256_set1_epi32( ( int )bias );
+	uint8_t y[ 24 ];
+	double  z[ 8 ];
+
+	for( ; n >= 8; n -= 8, x += 24, out += 8 )
+		cvt8( _mm256_srai_epi32(
+			_mm256_xor_si256( unpack24( x, swap ), b ), 8 ), out );
+
+	if( n > 0 )
+	{
+		memcpy( y, x, n * 3 );
+		cvt8( _mm256_srai_epi32(
+			_mm256_xor_si256( unpack24( y, swap ), b ), 8 ), z );
+		memcpy( out, z, n * sizeof( double ) );
+	}
+} /* decode_24() */
+
+/* Unsigned samples are biased by addition of 'bias' before truncation. */
+static AVX2 void encode_24( double const *in, void *out, int n,
+	double bias, int swap )
+{
+	uint8_t *y = ( uint8_t * )out;
+	__m256d b = _mm256_set1_pd( bias );
+	__m256d max = _mm256_set1_pd( MAX_INT24_VALUE );
+	__m256d min = _mm256_set1_pd( MIN_INT24_VALUE );
+	double  x[ 8 ];
+	uint8_t z[ 24 ];
+
+	for( ; n > 0; n -= 8, in += 8, y += 24 )
+	{
+		if( n < 8 )
+		{
+			memcpy( x, in, n * sizeof( double ) );
+			in = x;
+		}
+
+		pack24( _mm256_setr_m128i(
+			_mm256_cvttpd_epi32( _mm256_add_pd( _mm256_min_pd(
+				_mm256_max_pd( _mm256_loadu_pd( in ), min ), max ), b ) ),
+			_mm256_cvttpd_epi32( _mm256_add_pd( _mm256_min_pd(
+				_mm256_max_pd( _mm256_loadu_pd( in + 4 ), min ), max ), b ) ) ),
+			n < 8 ? z : y, swap );
+
+		if( n < 8 )
+			memcpy( y, z, n * 3 );
+	}
+} /* encode_24() */
+
+static AVX2 void decode_s24( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0, 0 );
+} /* decode_s24() */
+
+static AVX2 void encode_s24( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, 0.0, 0 );
+} /* encode_s24() */
+
+static AVX2 void decode_s24x( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0, 1 );
+} /* decode_s24x() */
+
+static AVX2 void encode_s24x( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, 0.0, 1 );
+} /* encode_s24x() */
+
+static AVX2 void decode_u24( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0x80000000, 0 );
+} /* decode_u24() */
+
+static AVX2 void encode_u24( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, MAX_INT24_VALUE + 1.0, 0 );
+} /* encode_u24() */
+
+static AVX2 void decode_u24x( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0x80000000, 1 );
+} /* decode_u24x() */
+
+static AVX2 void encode_u24x( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, MAX_INT24_VALUE + 1.0, 1 );
+} /* encode_u24x() */
+
+t_bs2b_kernel const bs2b_kernel_avx2 =
+{
+	BS2B_KERNEL_AVX2, "avx2",
+	cross_feed_d,
+	cross_feed_ahead_d,
+	cross_feed_f,
+	cross_feed_s16q,
+	cross_feed_s32q,
+	swap32,
+	zip_d,   zip_f,
+	unzip_d, unzip_f,
+	NULL,    NULL,      /* MXCSR is set by SSE2 */
+	NULL,
+	cross_feed_batch_f,
+	{
+		decode_dx,
+		decode_f,   decode_fx,
+		decode_s32, decode_s32x, decode_u32, decode_u32x,
+		decode_s16, decode_s16x, decode_u16, decode_u16x,
+		decode_s8,  decode_u8,
+		decode_s24, decode_s24x, decode_u24, decode_u24x
+	},
+	{
+		encode_dx,
+		encode_f,   encode_fx,
+		encode_s32, encode_s32x, encode_u32, encode_u32x,
+		encode_s16, encode_s16x, encode_u16, encode_u16x,
+		encode_s8,  encode_u8,
+		encode_s24, encode_s24x, encode_u24, encode_u24x
+	}
+};
+
+#endif /* BS2B_HAVE_AVX2 */
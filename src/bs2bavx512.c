@@ -0,0 +1,708 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "bs2bkernel.h"
+
+#ifdef BS2B_HAVE_AVX512
+
+#include <immintrin.h>
+
+#define AVX512 BS2B_TARGET( "avx512f,avx512vl,avx512bw,avx512dq" )
+
+/* A stereo sample recurrence does not get wider than four lanes,
+ * so the crossfeeds themselves are inherited from the AVX2 kernel,
+ * only look-ahead steps and a batch of streams fill 512 bit registers.
+ * Codecs use full 512 bit registers and masked tails, byte swapped
+ * doubles and floats are inherited as well.
+ */
+
+/* Lanes of a 128 bit quarter are one coefficient */
+#define QUAD_PD( v0, v1, v2, v3 ) \
+	_mm512_setr_pd( v0, v0, v1, v1, v2, v2, v3, v3 )
+
+/* A look-ahead step of four stereo samples 'x', 'd0', 'd1', 'd2' are
+ * the first three of them in all quarters. Output is 'y'.
+ */
+#define AHEAD_STEP \
+	lo = _mm512_fmadd_pd( p_lo, lfs_lo, \
+		_mm512_fmadd_pd( kc_lo, d0, \
+		_mm512_fmadd_pd( kb_lo, d1, \
+		_mm512_fmadd_pd( ka_lo, d2, _mm512_mul_pd( k0_lo, x ) ) ) ) ); \
+	hi = _mm512_fmadd_pd( p_hi, lfs_hi, \
+		_mm512_fmadd_pd( s_hi, asis, \
+		_mm512_fmadd_pd( kc_hi, d0, \
+		_mm512_fmadd_pd( kb_hi, d1, \
+		_mm512_fmadd_pd( ka_hi, d2, _mm512_mul_pd( k0_hi, x ) ) ) ) ) ); \
+	y = _mm512_mul_pd( _mm512_add_pd( hi, _mm512_permute_pd( lo, 0x55 ) ), \
+		gain )
+
+/* Look-ahead by four stereo samples in one register, see the AVX2
+ * kernel for the sums. The recurrence is one fused multiply-add and
+ * one shuffle per four stereo samples. Up to three last stereo samples
+ * are a masked step, whose state is taken from the last of them.
+ */
+static AVX512 void cross_feed_ahead_d( t_bs2bdp bs2bdp,
+	double const *in, double *out, int n )
+{
+	double  lc[ 4 ], hc[ 4 ], as[ 4 ], plo[ 5 ], phi[ 5 ];
+	__m512d k0_lo, ka_lo, kb_lo, kc_lo, p_lo;
+	__m512d k0_hi, ka_hi, kb_hi, kc_hi, s_hi, p_hi, gain;
+	__m512d asis, lfs_lo, lfs_hi, x, d0, d1, d2, lo, hi, y;
+	__m512i last;
+	__mmask8 k;
+	int     i;
+
+	if( n <= 0 ) return;
+
+	/* Powers of poles and coefficients by distance in stereo samples */
+	plo[ 0 ] = phi[ 0 ] = 1.0;
+	for( i = 1; i < 5; i++ )
+	{
+		plo[ i ] = plo[ i - 1 ] * bs2bdp->b1_lo;
+		phi[ i ] = phi[ i - 1 ] * bs2bdp->b1_hi;
+	}
+	hc[ 0 ] = bs2bdp->a0_hi;
+	for( i = 0; i < 4; i++ )
+	{
+		lc[ i ] = bs2bdp->a0_lo * plo[ i ];
+		as[ i ] = bs2bdp->a1_hi * phi[ i ];
+		if( i > 0 )
+			hc[ i ] = ( bs2bdp->a0_hi * bs2bdp->b1_hi + bs2bdp->a1_hi ) *
+				phi[ i - 1 ];
+	}
+
+	k0_lo = _mm512_set1_pd( lc[ 0 ] );
+	ka_lo = QUAD_PD( 0.0, 0.0, 0.0, lc[ 1 ] );
+	kb_lo = QUAD_PD( 0.0, 0.0, lc[ 1 ], lc[ 2 ] );
+	kc_lo = QUAD_PD( 0.0, lc[ 1 ], lc[ 2 ], lc[ 3 ] );
+	p_lo  = QUAD_PD( plo[ 1 ], plo[ 2 ], plo[ 3 ], plo[ 4 ] );
+	k0_hi = _mm512_set1_pd( hc[ 0 ] );
+	ka_hi = QUAD_PD( 0.0, 0.0, 0.0, hc[ 1 ] );
+	kb_hi = QUAD_PD( 0.0, 0.0, hc[ 1 ], hc[ 2 ] );
+	kc_hi = QUAD_PD( 0.0, hc[ 1 ], hc[ 2 ], hc[ 3 ] );
+	s_hi  = QUAD_PD( as[ 0 ], as[ 1 ], as[ 2 ], as[ 3 ] );
+	p_hi  = QUAD_PD( phi[ 1 ], phi[ 2 ], phi[ 3 ], phi[ 4 ] );
+	gain  = _mm512_set1_pd( bs2bdp->gain );
+
+	/* States of both channels in all quarters */
+	asis   = _mm512_broadcast_f64x2( _mm_loadu_pd( bs2bdp->lfs.asis ) );
+	lfs_lo = _mm512_broadcast_f64x2( _mm_loadu_pd( bs2bdp->lfs.lo ) );
+	lfs_hi = _mm512_broadcast_f64x2( _mm_loadu_pd( bs2bdp->lfs.hi ) );
+
+	for( i = n >> 2; i > 0; i-- )
+	{
+		x  = _mm512_loadu_pd( in );
+		d0 = _mm512_broadcast_f64x2( _mm_loadu_pd( in ) );
+		d1 = _mm512_broadcast_f64x2( _mm_loadu_pd( in + 2 ) );
+		d2 = _mm512_broadcast_f64x2( _mm_loadu_pd( in + 4 ) );
+
+		AHEAD_STEP;
+
+		/* The last stereo sample is the next state */
+		asis   = _mm512_shuffle_f64x2( x, x, 0xff );
+		lfs_lo = _mm512_shuffle_f64x2( lo, lo, 0xff );
+		lfs_hi = _mm512_shuffle_f64x2( hi, hi, 0xff );
+
+		_mm512_storeu_pd( out, y );
+
+		in  += 8;
+		out += 8;
+	} /* for */
+
+	if( n & 3 )
+	{
+		k  = ( __mmask8 )( ( 1 << ( n & 3 ) * 2 ) - 1 );
+		x  = _mm512_maskz_loadu_pd( k, in );
+		d0 = _mm512_shuffle_f64x2( x, x, 0x00 );
+		d1 = _mm512_shuffle_f64x2( x, x, 0x55 );
+		d2 = _mm512_shuffle_f64x2( x, x, 0xaa );
+
+		AHEAD_STEP;
+
+		last = _mm512_add_epi64( _mm512_set1_epi64( ( n & 3 ) * 2 - 2 ),
+			_mm512_setr_epi64( 0, 1, 0, 1, 0, 1, 0, 1 ) );
+		asis   = _mm512_permutexvar_pd( last, x );
+		lfs_lo = _mm512_permutexvar_pd( last, lo );
+		lfs_hi = _mm512_permutexvar_pd( last, hi );
+
+		_mm512_mask_storeu_pd( out, k, y );
+	} /* if */
+
+	_mm_storeu_pd( bs2bdp->lfs.asis, _mm512_castpd512_pd128( asis ) );
+	_mm_storeu_pd( bs2bdp->lfs.lo, _mm512_castpd512_pd128( lfs_lo ) );
+	_mm_storeu_pd( bs2bdp->lfs.hi, _mm512_castpd512_pd128( lfs_hi ) );
+} /* cross_feed_ahead_d() */
+
+/* Transposes 8 x 8 floats in place. A macro rather than a function, so
+ * that the rows stay in registers.
+ */
+#define TRANSPOSE8( t ) \
+{ \
+	__m256 a0, a1, a2, a3, a4, a5, a6, a7; \
+	__m256 b0, b1, b2, b3, b4, b5, b6, b7; \
+\
+	a0 = _mm256_unpacklo_ps( t[ 0 ], t[ 1 ] ); \
+	a1 = _mm256_unpackhi_ps( t[ 0 ], t[ 1 ] ); \
+	a2 = _mm256_unpacklo_ps( t[ 2 ], t[ 3 ] ); \
+	a3 = _mm256_unpackhi_ps( t[ 2 ], t[ 3 ] ); \
+	a4 = _mm256_unpacklo_ps( t[ 4 ], t[ 5 ] ); \
+	a5 = _mm256_unpackhi_ps( t[ 4 ], t[ 5 ] ); \
+	a6 = _mm256_unpacklo_ps( t[ 6 ], t[ 7 ] ); \
+	a7 = _mm256_unpackhi_ps( t[ 6 ], t[ 7 ] ); \
+\
+	b0 = _mm256_shuffle_ps( a0, a2, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b1 = _mm256_shuffle_ps( a0, a2, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+	b2 = _mm256_shuffle_ps( a1, a3, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b3 = _mm256_shuffle_ps( a1, a3, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+	b4 = _mm256_shuffle_ps( a4, a6, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b5 = _mm256_shuffle_ps( a4, a6, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+	b6 = _mm256_shuffle_ps( a5, a7, _MM_SHUFFLE( 1, 0, 1, 0 ) ); \
+	b7 = _mm256_shuffle_ps( a5, a7, _MM_SHUFFLE( 3, 2, 3, 2 ) ); \
+\
+	t[ 0 ] = _mm256_permute2f128_ps( b0, b4, 0x20 ); \
+	t[ 1 ] = _mm256_permute2f128_ps( b1, b5, 0x20 ); \
+	t[ 2 ] = _mm256_permute2f128_ps( b2, b6, 0x20 ); \
+	t[ 3 ] = _mm256_permute2f128_ps( b3, b7, 0x20 ); \
+	t[ 4 ] = _mm256_permute2f128_ps( b0, b4, 0x31 ); \
+	t[ 5 ] = _mm256_permute2f128_ps( b1, b5, 0x31 ); \
+	t[ 6 ] = _mm256_permute2f128_ps( b2, b6, 0x31 ); \
+	t[ 7 ] = _mm256_permute2f128_ps( b3, b7, 0x31 ); \
+}
+
+/* One stereo sample of sixteen streams in 'x0', 'x1' through the filters */
+#define BATCH_STEP( x0, x1 ) \
+	lo0 = _mm512_fmadd_ps( b1_lo, lo0, _mm512_mul_ps( a0_lo, x0 ) ); \
+	lo1 = _mm512_fmadd_ps( b1_lo, lo1, _mm512_mul_ps( a0_lo, x1 ) ); \
+	hi0 = _mm512_fmadd_ps( b1_hi, hi0, \
+		_mm512_fmadd_ps( a1_hi, asis0, _mm512_mul_ps( a0_hi, x0 ) ) ); \
+	hi1 = _mm512_fmadd_ps( b1_hi, hi1, \
+		_mm512_fmadd_ps( a1_hi, asis1, _mm512_mul_ps( a0_hi, x1 ) ) ); \
+	asis0 = x0; \
+	asis1 = x1; \
+	x0 = _mm512_mul_ps( _mm512_add_ps( hi0, lo1 ), gain ); \
+	x1 = _mm512_mul_ps( _mm512_add_ps( hi1, lo0 ), gain )
+
+/* Streams of a batch in lanes, sixteen at a time.
+ * The result is bit-exact with the AVX2 cross_feed_f().
+ */
+static AVX512 void cross_feed_batch_f( t_bs2b_batchp batch, size_t first,
+	float * const *sample, int n )
+{
+	__m512 a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain;
+	__m512 asis0, asis1, lo0, lo1, hi0, hi1, x0, x1;
+	__m256 t[ 8 ], u[ 8 ];
+	__m512 v[ 8 ];
+	float  l[ 16 ], r[ 16 ];
+	size_t k;
+	int    i, j;
+
+	for( k = 0; k < BS2B_BATCH_LANES; k += 16 )
+	{
+		a0_lo = _mm512_loadu_ps( batch->a0_lo + first + k );
+		b1_lo = _mm512_loadu_ps( batch->b1_lo + first + k );
+		a0_hi = _mm512_loadu_ps( batch->a0_hi + first + k );
+		a1_hi = _mm512_loadu_ps( batch->a1_hi + first + k );
+		b1_hi = _mm512_loadu_ps( batch->b1_hi + first + k );
+		gain  = _mm512_loadu_ps( batch->gain + first + k );
+
+		asis0 = _mm512_loadu_ps( batch->asis[ 0 ] + first + k );
+		asis1 = _mm512_loadu_ps( batch->asis[ 1 ] + first + k );
+		lo0   = _mm512_loadu_ps( batch->lo[ 0 ] + first + k );
+		lo1   = _mm512_loadu_ps( batch->lo[ 1 ] + first + k );
+		hi0   = _mm512_loadu_ps( batch->hi[ 0 ] + first + k );
+		hi1   = _mm512_loadu_ps( batch->hi[ 1 ] + first + k );
+
+		/* Four stereo samples of two groups of eight streams are
+		 * transposed to lanes
+		 */
+		for( i = 0; i + 4 <= n; i += 4 )
+		{
+			for( j = 0; j < 8; j++ )
+			{
+				t[ j ] = _mm256_loadu_ps( sample[ k + j ] + i * 2 );
+				u[ j ] = _mm256_loadu_ps( sample[ k + j + 8 ] + i * 2 );
+			}
+			TRANSPOSE8( t )
+			TRANSPOSE8( u )
+			for( j = 0; j < 8; j++ )
+				v[ j ] = _mm512_insertf32x8(
+					_mm512_castps256_ps512( t[ j ] ), u[ j ], 1 );
+
+			BATCH_STEP( v[ 0 ], v[ 1 ] );
+			BATCH_STEP( v[ 2 ], v[ 3 ] );
+			BATCH_STEP( v[ 4 ], v[ 5 ] );
+			BATCH_STEP( v[ 6 ], v[ 7 ] );
+
+			for( j = 0; j < 8; j++ )
+			{
+				t[ j ] = _mm512_castps512_ps256( v[ j ] );
+				u[ j ] = _mm512_extractf32x8_ps( v[ j ], 1 );
+			}
+			TRANSPOSE8( t )
+			TRANSPOSE8( u )
+			for( j = 0; j < 8; j++ )
+			{
+				_mm256_storeu_ps( sample[ k + j ] + i * 2, t[ j ] );
+				_mm256_storeu_ps( sample[ k + j + 8 ] + i * 2, u[ j ] );
+			}
+		} /* for */
+
+		/* Rest of stereo samples one by one */
+		for( ; i < n; i++ )
+		{
+			for( j = 0; j < 16; j++ )
+			{
+				l[ j ] = sample[ k + j ][ i * 2 ];
+				r[ j ] = sample[ k + j ][ i * 2 + 1 ];
+			}
+
+			x0 = _mm512_loadu_ps( l );
+			x1 = _mm512_loadu_ps( r );
+			BATCH_STEP( x0, x1 );
+			_mm512_storeu_ps( l, x0 );
+			_mm512_storeu_ps( r, x1 );
+
+			for( j = 0; j < 16; j++ )
+			{
+				sample[ k + j ][ i * 2 ]     = l[ j ];
+				sample[ k + j ][ i * 2 + 1 ] = r[ j ];
+			}
+		} /* for */
+
+		_mm512_storeu_ps( batch->asis[ 0 ] + first + k, asis0 );
+		_mm512_storeu_ps( batch->asis[ 1 ] + first + k, asis1 );
+		_mm512_storeu_ps( batch->lo[ 0 ] + first + k, lo0 );
+		_mm512_storeu_ps( batch->lo[ 1 ] + first + k, lo1 );
+		_mm512_storeu_ps( batch->hi[ 0 ] + first + k, hi0 );
+		_mm512_storeu_ps( batch->hi[ 1 ] + first + k, hi1 );
+	} /* for */
+} /* cross_feed_batch_f() */
+
+static AVX512 void decode_f( void const *in, double *out, int n )
+{
+	float const *x = ( float const * )in;
+	__mmask8 k;
+
+	for( ; n >= 8; n -= 8, x += 8, out += 8 )
+		_mm512_storeu_pd( out, _mm512_cvtps_pd( _mm256_loadu_ps( x ) ) );
+
+	if( n > 0 )
+	{
+		k = ( __mmask8 )( ( 1u << n ) - 1 );
+		_mm512_mask_storeu_pd( out, k,
+			_mm512_cvtps_pd( _mm256_maskz_loadu_ps( k, x ) ) );
+	}
+} /* decode_f() */
+
+static AVX512 void encode_f( double const *in, void *out, int n )
+{
+	float *y = ( float * )out;
+	__mmask8 k;
+
+	for( ; n >= 8; n -= 8, in += 8, y += 8 )
+		_mm256_storeu_ps( y, _mm512_cvtpd_ps( _mm512_loadu_pd( in ) ) );
+
+	if( n > 0 )
+	{
+		k = ( __mmask8 )( ( 1u << n ) - 1 );
+		_mm256_mask_storeu_ps( y, k,
+			_mm512_cvtpd_ps( _mm512_maskz_loadu_pd( k, in ) ) );
+	}
+} /* encode_f() */
+
+/* Integer codecs. Unsigned formats are biased to signed ones by XOR.
+ * 8 and 16 bit samples are clipped by saturating down conversion:
+ * a crossfeed of these formats never gets out of 32 bit integer range.
+ */
+
+#define MAX_INT32_VALUE  2147483647.0
+#define MIN_INT32_VALUE -2147483648.0
+
+/* Mask of 'n' low lanes, up to 16 */
+#define TAIL( n ) ( ( __mmask16 )( ( n ) >= 16 ? 0xffff : ( 1u << ( n ) ) - 1 ) )
+
+/* Byte shuffles of 16 and 32 bit lanes */
+#define SWAP16 _mm512_broadcast_i32x4( _mm_setr_epi8( 1, 0, 3, 2, 5, 4, 7, 6, \
+	9, 8, 11, 10, 13, 12, 15, 14 ) )
+#define SWAP32 _mm512_broadcast_i32x4( _mm_setr_epi8( 3, 2, 1, 0, 7, 6, 5, 4, \
+	11, 10, 9, 8, 15, 14, 13, 12 ) )
+
+/* Converts 16 32 bit integers to doubles by 'k' mask */
+static AVX512 void cvt16( __m512i v, double *out, __mmask16 k )
+{
+	_mm512_mask_storeu_pd( out, ( __mmask8 )k,
+		_mm512_cvtepi32_pd( _mm512_castsi512_si256( v ) ) );
+	_mm512_mask_storeu_pd( out + 8, ( __mmask8 )( k >> 8 ),
+		_mm512_cvtepi32_pd( _mm512_extracti64x4_epi64( v, 1 ) ) );
+} /* cvt16() */
+
+/* Truncates 16 doubles to 32 bit integers by 'k' mask */
+static AVX512 __m512i cvtt16( double const *in, __mmask16 k )
+{
+	return _mm512_inserti64x4( _mm512_castsi256_si512( _mm512_cvttpd_epi32(
+		_mm512_maskz_loadu_pd( ( __mmask8 )k, in ) ) ),
+		_mm512_cvttpd_epi32(
+		_mm512_maskz_loadu_pd( ( __mmask8 )( k >> 8 ), in + 8 ) ), 1 );
+} /* cvtt16() */
+
+static AVX512 void decode_32( void const *in, double *out, int n,
+	uint32_t bias, int swap )
+{
+	uint32_t const *x = ( uint32_t const * )in;
+	__m512i b = _mm512_set1_epi32( ( int )bias ), s = SWAP32, v;
+	__mmask16 k;
+
+	for( ; n > 0; n -= 16, x += 16, out += 16 )
+	{
+		k = TAIL( n );
+		v = _mm512_maskz_loadu_epi32( k, x );
+		if( swap ) v = _mm512_shuffle_epi8( v, s );
+		cvt16( _mm512_xor_si512( v, b ), out, k );
+	}
+} /* decode_32() */
+
+static AVX512 void encode_32( double const *in, void *out, int n,
+	uint32_t bias, int swap )
+{
+	uint32_t *y = ( uint32_t * )out;
+	__m256i b = _mm256_set1_epi32( ( int )bias ), v;
+	__m256i s = _mm512_castsi512_si256( SWAP32 );
+	__m512d max = _mm512_set1_pd( MAX_INT32_VALUE );
+	__m512d min = _mm512_set1_pd( MIN_INT32_VALUE );
+	__mmask8 k;
+
+	for( ; n > 0; n -= 8, in += 8, y += 8 )
+	{
+		k = ( __mmask8 )TAIL( n );
+		v = _mm256_xor_si256( _mm512_cvttpd_epi32( _mm512_min_pd(
+			_mm512_max_pd( _mm512_maskz_loadu_pd( k, in ), min ), max ) ), b );
+		if( swap ) v = _mm256_shuffle_epi8( v, s );
+		_mm256_mask_storeu_epi32( y, k, v );
+	}
+} /* encode_32() */
+
+static AVX512 void decode_16( void const *in, double *out, int n,
+	uint16_t bias, int swap )
+{
+	uint16_t const *x = ( uint16_t const * )in;
+	__m256i b = _mm256_set1_epi16( ( short )bias ), v;
+	__m256i s = _mm512_castsi512_si256( SWAP16 );
+	__mmask16 k;
+
+	for( ; n > 0; n -= 16, x += 16, out += 16 )
+	{
+		k = TAIL( n );
+		v = _mm256_maskz_loadu_epi16( k, x );
+		if( swap ) v = _mm256_shuffle_epi8( v, s );
+		cvt16( _mm512_cvtepi16_epi32( _mm256_xor_si256( v, b ) ), out, k );
+	}
+} /* decode_16() */
+
+static AVX512 void encode_16( double const *in, void *out, int n,
+	uint16_t bias, int swap )
+{
+	uint16_t *y = ( uint16_t * )out;
+	__m256i b = _mm256_set1_epi16( ( short )bias ), v;
+	__m256i s = _mm512_castsi512_si256( SWAP16 );
+	__mmask16 k;
+
+	for( ; n > 0; n -= 16, in += 16, y += 16 )
+	{
+		k = TAIL( n );
+		v = _mm256_xor_si256( _mm512_cvtsepi32_epi16( cvtt16( in, k ) ), b );
+		if( swap ) v = _mm256_shuffle_epi8( v, s );
+		_mm256_mask_storeu_epi16( y, k, v );
+	}
+} /* encode_16() */
+
+static AVX512 void decode_8( void const *in, double *out, int n, uint8_t bias )
+{
+	uint8_t const *x = ( uint8_t const * )in;
+	__m128i b = _mm_set1_epi8( ( char )bias );
+	__mmask16 k;
+
+	for( ; n > 0; n -= 16, x += 16, out += 16 )
+	{
+		k = TAIL( n );
+		cvt16( _mm512_cvtepi8_epi32( _mm_xor_si128(
+			_mm_maskz_loadu_epi8( k, x ), b ) ), out, k );
+	}
+} /* decode_8() */
+
+static AVX512 void encode_8( double const *in, void *out, int n, uint8_t bias )
+{
+	uint8_t *y = ( uint8_t * )out;
+	__m128i b = _mm_set1_epi8( ( char )bias );
+	__mmask16 k;
+
+	for( ; n > 0; n -= 16, in += 16, y += 16 )
+	{
+		k = TAIL( n );
+		_mm_mask_storeu_epi8( y, k, _mm_xor_si128(
+			_mm512_cvtsepi32_epi8( cvtt16( in, k ) ), b ) );
+	}
+} /* encode_8() */
+
+static AVX512 void decode_s32( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0, 0 );
+} /* decode_s32() */
+
+static AVX512 void encode_s32( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0, 0 );
+} /* encode_s32() */
+
+static AVX512 void decode_s32x( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0, 1 );
+} /* decode_s32x() */
+
+static AVX512 void encode_s32x( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0, 1 );
+} /* encode_s32x() */
+
+static AVX512 void decode_u32( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0x80000000, 0 );
+} /* decode_u32() */
+
+static AVX512 void encode_u32( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0x80000000, 0 );
+} /* encode_u32() */
+
+static AVX512 void decode_u32x( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0x80000000, 1 );
+} /* decode_u32x() */
+
+static AVX512 void encode_u32x( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0x80000000, 1 );
+} /* encode_u32x() */
+
+static AVX512 void decode_s16( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0, 0 );
+} /* decode_s16() */
+
+static AVX512 void encode_s16( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0, 0 );
+} /* encode_s16() */
+
+static AVX512 void decode_s16x( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0, 1 );
+} /* decode_s16x() */
+
+static AVX512 void encode_s16x( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0, 1 );
+} /* encode_s16x() */
+
+static AVX512 void decode_u16( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0x8000, 0 );
+} /* decode_u16() */
+
+static AVX512 void encode_u16( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0x8000, 0 );
+} /* encode_u16() */
+
+static AVX512 void decode_u16x( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0x8000, 1 );
+} /* decode_u16x() */
+
+static AVX512 void encode_u16x( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0x8000, 1 );
+} /* encode_u16x() */
+
+static AVX512 void decode_s8( void const *in, double *out, int n )
+{
+	decode_8( in, out, n, 0 );
+} /* decode_s8() */
+
+static AVX512 void encode_s8( double const *in, void *out, int n )
+{
+	encode_8( in, out, n, 0 );
+} /* encode_s8() */
+
+static AVX512 void decode_u8( void const *in, double *out, int n )
+{
+	decode_8( in, out, n, 0x80 );
+} /* decode_u8() */
+
+static AVX512 void encode_u8( double const *in, void *out, int n )
+{
+	encode_8( in, out, n, 0x80 );
+} /* encode_u8() */
+
+/* 24 bit codecs. Up to 16 packed samples are moved by a masked byte
+ * load or store, spread to or gathered from 12 bytes of each 128 bit
+ * lane by a word permutation and the bytes are rearranged by one byte
+ * shuffle. Samples are unpacked to high 24 bits of 32 bit lanes and
+ * sign extended by an arithmetic shift.
+ */
+
+#define MAX_INT24_VALUE     8388607.0
+#define MIN_INT24_VALUE    -8388608.0
+
+/* Mask of 'n' low 24 bit samples in bytes, up to 16 */
+#define TAIL24( n ) \
+	( ( ( __mmask64 )1 << ( ( n ) >= 16 ? 48 : ( n ) * 3 ) ) - 1 )
+
+/* Byte shuffles of unpacked and packed 24 bit samples */
+#define UNPACK24 _mm512_broadcast_i32x4( _mm_setr_epi8( \
+	-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11 ) )
+#define UNPACK24X _mm512_broadcast_i32x4( _mm_setr_epi8( \
+	-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9 ) )
+#define PACK24 _mm512_broadcast_i32x4( _mm_setr_epi8( \
+	0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1 ) )
+#define PACK24X _mm512_broadcast_i32x4( _mm_setr_epi8( \
+	2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 ) )
+
+/* Unsigned samples are biased by XOR of 'bias' to unpacked words. */
+static AVX512 void decode_24( void const *in, double *out, int n,
+	uint32_t bias, int swap )
+{
+	uint8_t const *x = ( uint8_t const * )in;
+	__m512i b = _mm512_set1_epi32( ( int )bias ), v;
+	__m512i s = swap ? UNPACK24X : UNPACK24;
+	__m512i p = _mm512_setr_epi32(
+		0, 1, 2, 2, 3, 4, 5, 5, 6, 7, 8, 8, 9, 10, 11, 11 );
+
+	for( ; n > 0; n -= 16, x += 48, out += 16 )
+	{
+		v = _mm512_maskz_loadu_epi8( TAIL24( n ), x );
+		v = _mm512_shuffle_epi8( _mm512_permutexvar_epi32( p, v ), s );
+		cvt16( _mm512_srai_epi32( _mm512_xor_si512( v, b ), 8 ), out,
+			TAIL( n ) );
+	}
+} /* decode_24() */
+
+/* Unsigned samples are biased by addition of 'bias' before truncation. */
+static AVX512 void encode_24( double const *in, void *out, int n,
+	double bias, int swap )
+{
+	uint8_t *y = ( uint8_t * )out;
+	__m512d b = _mm512_set1_pd( bias );
+	__m512d max = _mm512_set1_pd( MAX_INT24_VALUE );
+	__m512d min = _mm512_set1_pd( MIN_INT24_VALUE );
+	__m512i s = swap ? PACK24X : PACK24, v;
+	__m512i p = _mm512_setr_epi32(
+		0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 3, 7, 11, 15 );
+	__mmask16 k;
+
+	for( ; n > 0; n -= 16, in += 16, y += 48 )
+	{
+		k = TAIL( n );
+		v = _mm512_inserti64x4( _mm512_castsi256_si512( _mm512_cvttpd_epi32(
+			_mm512_add_pd( _mm512_min_pd( _mm512_max_pd(
+			_mm512_maskz_loadu_pd( ( __mmask8 )k, in ), min ), max ), b ) ) ),
+			_mm512_cvttpd_epi32( _mm512_add_pd( _mm512_min_pd( _mm512_max_pd(
+			_mm512_maskz_loadu_pd( ( __mmask8 )( k >> 8 ), in + 8 ),
+			min ), max ), b ) ), 1 );
+		v = _mm512_permutexvar_epi32( p, _mm512_shuffle_epi8( v, s ) );
+		_mm512_mask_storeu_epi8( y, TAIL24( n ), v );
+	}
+} /* encode_24() */
+
+static AVX512 void decode_s24( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0, 0 );
+} /* decode_s24() */
+
+static AVX512 void encode_s24( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, 0.0, 0 );
+} /* encode_s24() */
+
+static AVX512 void decode_s24x( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0, 1 );
+} /* decode_s24x() */
+
+static AVX512 void encode_s24x( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, 0.0, 1 );
+} /* encode_s24x() */
+
+static AVX512 void decode_u24( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0x80000000, 0 );
+} /* decode_u24() */
+
+static AVX512 void encode_u24( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, MAX_INT24_VALUE + 1.0, 0 );
+} /* encode_u24() */
+
+static AVX512 void decode_u24x( void const *in, double *out, int n )
+{
+	decode_24( in, out, n, 0x80000000, 1 );
+} /* decode_u24x() */
+
+static AVX512 void encode_u24x( double const *in, void *out, int n )
+{
+	encode_24( in, out, n, MAX_INT24_VALUE + 1.0, 1 );
+} /* encode_u24x() */
+
+t_bs2b_kernel const bs2b_kernel_avx512 =
+{
+	BS2B_KERNEL_AVX512, "avx512",
+	NULL,
+	cross_feed_ahead_d,
+	NULL,
+	NULL,
+	NULL,
+	NULL,
+	NULL,    NULL,
+	NULL,    NULL,
+	NULL,    NULL,
+	NULL,
+	cross_feed_batch_f,
+	{
+		NULL,       /* BS2B_FMT_DX */
+		decode_f,   NULL,
+		decode_s32, decode_s32x, decode_u32, decode_u32x,
+		decode_s16, decode_s16x, decode_u16, decode_u16x,
+		decode_s8,  decode_u8,
+		decode_s24, decode_s24x, decode_u24, decode_u24x
+	},
+	{
+		NULL,       /* BS2B_FMT_DX */
+		encode_f,   NULL,
+		encode_s32, encode_s32x, encode_u32, encode_u32x,
+		encode_s16, encode_s16x, encode_u16, encode_u16x,
+		encode_s8,  encode_u8,
+		encode_s24, encode_s24x, encode_u24, encode_u24x
+	}
+};
+
+#endif /* BS2B_HAVE_AVX512 */
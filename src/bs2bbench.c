@@ -0,0 +1,179 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Benchmarks BS2B_FLAG_DENORMAL_SAFE. A burst of noise is followed by
+ * silence, the buffer fades into denormals then. Prints an average and
+ * the worst cost of a block of the silence in ns per stereo sample
+ * by each engine without and with the flag.
+ * Usage : bs2bbench [blocks], the kernel is chosen as by the library.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include "bs2b.h"
+
+#define FRAMES 4096
+
+/* Blocks of silence before and during measurement */
+#define FADE_BLOCKS 200
+#define BENCH_BLOCKS 2000
+
+/* Engines of the benchmark */
+enum
+{
+	BENCH_DOUBLE,
+	BENCH_FLOAT,
+	BENCH_S16
+};
+
+static char const *const engines[] = { "double", "float", "s16" };
+
+/* Input stays intact, so silence is silence */
+static double  dbuf[ FRAMES * 2 ], dout[ FRAMES * 2 ];
+static float   fbuf[ FRAMES * 2 ], fout[ FRAMES * 2 ];
+static int16_t sbuf[ FRAMES * 2 ], sout[ FRAMES * 2 ];
+
+/* Wall clock in ns */
+static double now( void )
+{
+#ifdef _WIN32
+	LARGE_INTEGER count, freq;
+
+	QueryPerformanceCounter( &count );
+	QueryPerformanceFrequency( &freq );
+
+	return ( double )count.QuadPart * 1e9 / ( double )freq.QuadPart;
+#else
+	struct timeval tv;
+
+	gettimeofday( &tv, NULL );
+
+	return tv.tv_sec * 1e9 + tv.tv_usec * 1e3;
+#endif
+} /* now() */
+
+/* Fills buffers with noise or zeros */
+static void fill( int noise )
+{
+	int i;
+
+	for( i = 0; i < FRAMES * 2; i++ )
+	{
+		dbuf[ i ] = noise ? rand() / ( double )RAND_MAX - 0.5 : 0.0;
+		fbuf[ i ] = ( float )dbuf[ i ];
+		sbuf[ i ] = ( int16_t )( dbuf[ i ] * 32767.0 );
+	}
+} /* fill() */
+
+static void cross_feed( t_bs2bdp bs2bdp, int engine )
+{
+	switch( engine )
+	{
+	case BENCH_DOUBLE:
+		bs2b_cross_feed_d_to( bs2bdp, dbuf, dout, FRAMES );
+		break;
+	case BENCH_FLOAT:
+		bs2b_cross_feed_f_to( bs2bdp, fbuf, fout, FRAMES );
+		break;
+	case BENCH_S16:
+		bs2b_cross_feed_s16_to( bs2bdp, sbuf, sout, FRAMES );
+		break;
+	} /* switch */
+} /* cross_feed() */
+
+/* Return an average ns per stereo sample of silence after a burst,
+ * '*worst' is the worst one of a block
+ */
+static double bench( int engine, uint32_t flags, int blocks, double *worst )
+{
+	t_bs2bdp bs2bdp;
+	double   start, t, total = 0.0;
+	int      i;
+
+	*worst = 0.0;
+
+	if( NULL == ( bs2bdp = bs2b_open() ) ) return 0.0;
+
+	bs2b_set_flags( bs2bdp, flags |
+		( BENCH_FLOAT == engine ? BS2B_FLAG_FLOAT : 0 ) );
+
+	fill( 1 );
+	cross_feed( bs2bdp, engine );
+	fill( 0 );
+
+	for( i = 0; i < FADE_BLOCKS; i++ )
+		cross_feed( bs2bdp, engine );
+
+	for( i = 0; i < blocks; i++ )
+	{
+		start = now();
+		cross_feed( bs2bdp, engine );
+		t = now() - start;
+
+		total += t;
+		if( t > *worst ) *worst = t;
+	}
+
+	bs2b_close( bs2bdp );
+
+	*worst /= FRAMES;
+
+	return total / blocks / FRAMES;
+} /* bench() */
+
+int main( int argc, char *argv[] )
+{
+	double plain, safe, plain_worst, safe_worst;
+	int    blocks = BENCH_BLOCKS;
+	int    engine;
+
+	if( argc > 1 && ( blocks = atoi( argv[ 1 ] ) ) <= 0 )
+	{
+		printf( "Usage : %s [blocks]\n", argv[ 0 ] );
+		return 1;
+	}
+
+	printf( "Kernel %s, %d blocks of %d stereo samples of silence"
+		" after a burst.\n", bs2b_get_kernel_name(), blocks, FRAMES );
+	printf( "ns per stereo sample, average ( worst block ):\n" );
+	printf( "engine    without flag          BS2B_FLAG_DENORMAL_SAFE\n" );
+
+	for( engine = BENCH_DOUBLE; engine <= BENCH_S16; engine++ )
+	{
+		plain = bench( engine, 0, blocks, &plain_worst );
+		safe = bench( engine, BS2B_FLAG_DENORMAL_SAFE, blocks, &safe_worst );
+
+		printf( "%-8s  %8.2f ( %8.2f )   %8.2f ( %8.2f )\n", engines[ engine ],
+			plain, plain_worst, safe, safe_worst );
+	}
+
+	return 0;
+} /* main() */
@@ -0,0 +1,154 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Checks behaviour of the library through its interface, run on build.
+ * Return 1 and prints failures to stderr if any.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bs2b.h"
+
+#define FRAMES 1024
+
+#define COUNT( a ) ( int )( sizeof( a ) / sizeof( a[ 0 ] ) )
+
+/* Formats of the checks, see cross_feed_to() */
+enum
+{
+	CHECK_S16,
+	CHECK_U8,
+	CHECK_U16,
+	CHECK_U24,
+	CHECK_U32
+};
+
+static struct
+{
+	int        fmt;
+	int        size;
+	char const *name;
+} const formats[] =
+{
+	{ CHECK_U8,  1, "u8" },
+	{ CHECK_U16, 2, "u16" },
+	{ CHECK_U24, 3, "u24" },
+	{ CHECK_U32, 4, "u32" }
+};
+
+static void cross_feed_to( t_bs2bdp bs2bdp, int fmt,
+	void const *in, void *out, size_t n )
+{
+	switch( fmt )
+	{
+	case CHECK_S16:
+		bs2b_cross_feed_s16_to( bs2bdp, ( int16_t const * )in,
+			( int16_t * )out, n );
+		break;
+	case CHECK_U8:
+		bs2b_cross_feed_u8_to( bs2bdp, ( uint8_t const * )in,
+			( uint8_t * )out, n );
+		break;
+	case CHECK_U16:
+		bs2b_cross_feed_u16_to( bs2bdp, ( uint16_t const * )in,
+			( uint16_t * )out, n );
+		break;
+	case CHECK_U24:
+		bs2b_cross_feed_u24_to( bs2bdp, ( bs2b_uint24_t const * )in,
+			( bs2b_uint24_t * )out, n );
+		break;
+	case CHECK_U32:
+		bs2b_cross_feed_u32_to( bs2bdp, ( uint32_t const * )in,
+			( uint32_t * )out, n );
+		break;
+	} /* switch */
+} /* cross_feed_to() */
+
+/* Zero bytes of unsigned formats are full scale negative samples,
+ * BS2B_FLAG_SKIP_SILENCE must filter them as they are.
+ * Return a number of failures.
+ */
+static int check_unsigned_zeros( void )
+{
+	static unsigned char zeros[ FRAMES * 2 * 4 ];
+	static unsigned char out[ FRAMES * 2 * 4 ];
+	static unsigned char ref[ FRAMES * 2 * 4 ];
+	t_bs2bdp bs2bdp, plain;
+	int      errors = 0;
+	int      i;
+
+	bs2bdp = bs2b_open();
+	plain = bs2b_open();
+	if( NULL == bs2bdp || NULL == plain )
+	{
+		fprintf( stderr, "bs2bcheck: not enough memory\n" );
+		bs2b_close( bs2bdp );
+		bs2b_close( plain );
+		return 1;
+	}
+
+	bs2b_set_flags( bs2bdp, BS2B_FLAG_SKIP_SILENCE );
+
+	/* Signed zeros of a clear buffer are skipped */
+	memset( out, 0xff, sizeof( out ) );
+	cross_feed_to( bs2bdp, CHECK_S16, zeros, out, FRAMES );
+	if( bs2b_get_skipped( bs2bdp ) != FRAMES ||
+		memcmp( out, zeros, FRAMES * 2 * 2 ) != 0 )
+	{
+		fprintf( stderr, "bs2bcheck: s16 zeros are not skipped\n" );
+		errors++;
+	}
+
+	for( i = 0; i < COUNT( formats ); i++ )
+	{
+		bs2b_clear( bs2bdp );
+		bs2b_clear( plain );
+		bs2b_reset_skipped( bs2bdp );
+
+		cross_feed_to( bs2bdp, formats[ i ].fmt, zeros, out, FRAMES );
+		cross_feed_to( plain, formats[ i ].fmt, zeros, ref, FRAMES );
+
+		if( bs2b_get_skipped( bs2bdp ) != 0 ||
+			memcmp( out, ref, FRAMES * 2 * formats[ i ].size ) != 0 )
+		{
+			fprintf( stderr, "bs2bcheck: %s zeros are skipped as silence\n",
+				formats[ i ].name );
+			errors++;
+		}
+	}
+
+	bs2b_close( bs2bdp );
+	bs2b_close( plain );
+
+	return errors;
+} /* check_unsigned_zeros() */
+
+int main( void )
+{
+	int errors = 0;
+
+	errors += check_unsigned_zeros();
+
+	return errors ? 1 : 0;
+} /* main() */
@@ -43,6 +43,11 @@ uint32_t bs2b_base::get_level()
 	return bs2b_get_level( bs2bdp );
 }
 
+void bs2b_base::post_level( uint32_t level )
+{
+	bs2b_post_level( bs2bdp, level );
+}
+
 void bs2b_base::set_level_fcut( int fcut )
 {
 	bs2b_set_level_fcut( bs2bdp, fcut );
@@ -73,6 +78,11 @@ void bs2b_base::set_srate( uint32_t srate )
 	bs2b_set_srate( bs2bdp, srate );
 }
 
+void bs2b_base::configure( uint32_t srate, uint32_t level )
+{
+	bs2b_configure( bs2bdp, srate, level );
+}
+
 uint32_t bs2b_base::get_srate()
 {
 	return bs2b_get_srate( bs2bdp );
@@ -88,6 +98,46 @@ bool bs2b_base::is_clear()
 	return( bs2b_is_clear( bs2bdp ) ? true : false );
 }
 
+void bs2b_base::advance_silence( size_t n )
+{
+	bs2b_advance_silence( bs2bdp, n );
+}
+
+size_t bs2b_base::settle_frames( double eps )
+{
+	return bs2b_settle_frames( bs2bdp, eps );
+}
+
+void bs2b_base::set_flags( uint32_t flags )
+{
+	bs2b_set_flags( bs2bdp, flags );
+}
+
+uint32_t bs2b_base::get_flags()
+{
+	return bs2b_get_flags( bs2bdp );
+}
+
+void bs2b_base::set_silence_level( double level )
+{
+	bs2b_set_silence_level( bs2bdp, level );
+}
+
+double bs2b_base::get_silence_level()
+{
+	return bs2b_get_silence_level( bs2bdp );
+}
+
+size_t bs2b_base::get_skipped()
+{
+	return bs2b_get_skipped( bs2bdp );
+}
+
+void bs2b_base::reset_skipped()
+{
+	bs2b_reset_skipped( bs2bdp );
+}
+
 char const *bs2b_base::runtime_version( void )
 {
 	return bs2b_runtime_version();
@@ -37,15 +37,25 @@ public:
 
 	void     set_level( uint32_t level );
 	uint32_t get_level();
+	void     post_level( uint32_t level );
 	void     set_level_fcut( int fcut );
 	int      get_level_fcut();
 	void     set_level_feed( int feed );
 	int      get_level_feed();
 	int      get_level_delay();
 	void     set_srate( uint32_t srate );
+	void     configure( uint32_t srate, uint32_t level );
 	uint32_t get_srate();
 	void     clear();
 	bool     is_clear();
+	void     advance_silence( size_t n );
+	size_t   settle_frames( double eps );
+	void     set_flags( uint32_t flags );
+	uint32_t get_flags();
+	void     set_silence_level( double level );
+	double   get_silence_level();
+	size_t   get_skipped();
+	void     reset_skipped();
 
 	char const *runtime_version( void );
 	uint32_t    runtime_version_int( void );
@@ -179,6 +189,208 @@ public:
 	{
 		bs2b_cross_feed_u24le( bs2bdp, sample, n );
 	}
+
+	inline void cross_feed( double const *in, double *out, size_t n )
+	{
+		bs2b_cross_feed_d_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( double const *in, double *out, size_t n )
+	{
+		bs2b_cross_feed_dbe_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( double const *in, double *out, size_t n )
+	{
+		bs2b_cross_feed_dle_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( float const *in, float *out, size_t n )
+	{
+		bs2b_cross_feed_f_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( float const *in, float *out, size_t n )
+	{
+		bs2b_cross_feed_fbe_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( float const *in, float *out, size_t n )
+	{
+		bs2b_cross_feed_fle_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( int32_t const *in, int32_t *out, size_t n )
+	{
+		bs2b_cross_feed_s32_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( uint32_t const *in, uint32_t *out, size_t n )
+	{
+		bs2b_cross_feed_u32_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( int32_t const *in, int32_t *out, size_t n )
+	{
+		bs2b_cross_feed_s32be_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( uint32_t const *in, uint32_t *out, size_t n )
+	{
+		bs2b_cross_feed_u32be_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( int32_t const *in, int32_t *out, size_t n )
+	{
+		bs2b_cross_feed_s32le_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( uint32_t const *in, uint32_t *out, size_t n )
+	{
+		bs2b_cross_feed_u32le_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( int16_t const *in, int16_t *out, size_t n )
+	{
+		bs2b_cross_feed_s16_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( uint16_t const *in, uint16_t *out, size_t n )
+	{
+		bs2b_cross_feed_u16_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( int16_t const *in, int16_t *out, size_t n )
+	{
+		bs2b_cross_feed_s16be_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( uint16_t const *in, uint16_t *out, size_t n )
+	{
+		bs2b_cross_feed_u16be_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( int16_t const *in, int16_t *out, size_t n )
+	{
+		bs2b_cross_feed_s16le_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( uint16_t const *in, uint16_t *out, size_t n )
+	{
+		bs2b_cross_feed_u16le_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( int8_t const *in, int8_t *out, size_t n )
+	{
+		bs2b_cross_feed_s8_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( uint8_t const *in, uint8_t *out, size_t n )
+	{
+		bs2b_cross_feed_u8_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( bs2b_int24_t const *in, bs2b_int24_t *out, size_t n )
+	{
+		bs2b_cross_feed_s24_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed( bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n )
+	{
+		bs2b_cross_feed_u24_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( bs2b_int24_t const *in, bs2b_int24_t *out, size_t n )
+	{
+		bs2b_cross_feed_s24be_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_be( bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n )
+	{
+		bs2b_cross_feed_u24be_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( bs2b_int24_t const *in, bs2b_int24_t *out, size_t n )
+	{
+		bs2b_cross_feed_s24le_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_le( bs2b_uint24_t const *in, bs2b_uint24_t *out, size_t n )
+	{
+		bs2b_cross_feed_u24le_to( bs2bdp, in, out, n );
+	}
+
+	inline void cross_feed_planar( double *left, double *right, size_t n )
+	{
+		bs2b_cross_feed_planar_d( bs2bdp, left, right, n );
+	}
+
+	inline void cross_feed_planar( float *left, float *right, size_t n )
+	{
+		bs2b_cross_feed_planar_f( bs2bdp, left, right, n );
+	}
+
+	inline void cross_feed_planar( double const *in_left, double const *in_right,
+		double *out_left, double *out_right, size_t n )
+	{
+		bs2b_cross_feed_planar_d_to( bs2bdp,
+			in_left, in_right, out_left, out_right, n );
+	}
+
+	inline void cross_feed_planar( float const *in_left, float const *in_right,
+		float *out_left, float *out_right, size_t n )
+	{
+		bs2b_cross_feed_planar_f_to( bs2bdp,
+			in_left, in_right, out_left, out_right, n );
+	}
+
+	inline void cross_feed_stride( double *sample, size_t n,
+		int channels, int left, int right )
+	{
+		bs2b_cross_feed_stride_d( bs2bdp, sample, n, channels, left, right );
+	}
+
+	inline void cross_feed_stride( float *sample, size_t n,
+		int channels, int left, int right )
+	{
+		bs2b_cross_feed_stride_f( bs2bdp, sample, n, channels, left, right );
+	}
+
+	inline void cross_feed_events( double *sample, size_t n,
+		t_bs2b_event const *event, size_t count )
+	{
+		bs2b_cross_feed_events_d( bs2bdp, sample, n, event, count );
+	}
+
+	inline void cross_feed_events( float *sample, size_t n,
+		t_bs2b_event const *event, size_t count )
+	{
+		bs2b_cross_feed_events_f( bs2bdp, sample, n, event, count );
+	}
+
+	inline void cross_feed_events( double const *in, double *out, size_t n,
+		t_bs2b_event const *event, size_t count )
+	{
+		bs2b_cross_feed_events_d_to( bs2bdp, in, out, n, event, count );
+	}
+
+	inline void cross_feed_events( float const *in, float *out, size_t n,
+		t_bs2b_event const *event, size_t count )
+	{
+		bs2b_cross_feed_events_f_to( bs2bdp, in, out, n, event, count );
+	}
+
+	inline void cross_feed_parallel( double *sample, size_t n,
+		int threads = 0 )
+	{
+		bs2b_cross_feed_parallel_d( bs2bdp, sample, n, threads );
+	}
+
+	inline void cross_feed_parallel( double const *in, double *out, size_t n,
+		int threads = 0 )
+	{
+		bs2b_cross_feed_parallel_d_to( bs2bdp, in, out, n, threads );
+	}
 }; // class bs2b_base
 
 #endif // BS2BCLASS_H
@@ -24,6 +24,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#endif
 
 /* libsndfile is copyright by Erik de Castro Lopo.
  * http://www.mega-nerd.com/libsndfile/
@@ -31,11 +41,157 @@
 #include <sndfile.h>
 
 #include "bs2b.h"
+#include "bs2bthread.h"
 
 #define	 BUFFER_LEN	1024 /* must be multiply of 2 */
 
+/* Parallel conversion differs from a serial one by less than that
+ * ( -200 dB ), far under LSB of 24 bit samples
+ */
+#define	 SETTLE_EPS	1e-10
+
+/* Buffers of the read - crossfeed - write pipeline of copy_data(),
+ * a power of 2
+ */
+#define	 PIPE_BUFFERS	8
+
+/* Default, the longest block (stereo samples) of copy_data() and
+ * alignment of its buffers (bytes, a power of 2)
+ */
+#define	 BLOCK_LEN	4096
+#define	 BLOCK_MAX	( 1 << 20 )
+#define	 BLOCK_ALIGN	64
+
+/* Sample types of PCM WAV data mapped by map_data() */
+enum
+{
+	WAV_U8,
+	WAV_S16,
+	WAV_S24,
+	WAV_S32,
+	WAV_F32,
+	WAV_F64
+};
+
+/* Stereo samples crossfed at once from a mapped file */
+#define	 MAP_FRAMES	65536
+
+/* Bytes per sample of WAV_* */
+static size_t const wav_bytes[] = { 1, 2, 3, 4, 4, 8 };
+
+/* Sample types of copy_data() */
+enum
+{
+	IO_SHORT,
+	IO_INT,
+	IO_FLOAT,
+	IO_DOUBLE
+};
+
+/* Shortest part of a file per thread (stereo samples) */
+#define	 PART_MIN_FRAMES	65536
+
+/* A part of a file converted by one thread */
+typedef struct
+{
+	char const  *infilename;
+	SNDFILE     *outfile;    /* The first part is written directly, */
+	FILE        *tmpfile;    /* others are kept until their turn */
+	uint32_t    srate;
+	uint32_t    level;
+	sf_count_t  start;       /* First stereo sample */
+	sf_count_t  frames;
+	sf_count_t  preroll;     /* Warm-up stereo samples before 'start' */
+	int         last;        /* Up to the end of a file */
+	int         error;
+	bs2b_thread thread;
+	int         started;
+} t_part;
+
+/* An auto-reset event a stage of the pipeline sleeps on */
+#ifdef _WIN32
+typedef HANDLE t_signal;
+#else
+typedef struct
+{
+	pthread_mutex_t lock;
+	pthread_cond_t  cond;
+	int             raised;
+} t_signal;
+#endif
+
+/* Single producer single consumer ring of buffer indices */
+typedef struct
+{
+	bs2b_atomic head;    /* Count of pushed */
+	bs2b_atomic tail;    /* Count of popped */
+	int         slot[ PIPE_BUFFERS ];
+	t_signal    pushed;  /* Raised on every push */
+} t_queue;
+
+/* Buffers go round from the reader thread through the DSP stage
+ * to the writer thread and back. A buffer with no samples is the end.
+ */
+typedef struct
+{
+	SNDFILE *infile;
+	SNDFILE *outfile;
+	int     io;          /* IO_* */
+	int     len;         /* Samples per buffer */
+	void    *data[ PIPE_BUFFERS ];
+	int     count[ PIPE_BUFFERS ];
+	t_queue empty;       /* writer -> reader */
+	t_queue full;        /* reader -> DSP */
+	t_queue done;        /* DSP -> writer */
+} t_pipe;
+
+/* A file of a batch */
+typedef struct
+{
+	char       *infilename;
+	char       *outfilename;
+	sf_count_t frames;        /* Converted stereo samples */
+	int        srate;
+	double     seconds;       /* Wall time of conversion */
+	char const *error;        /* NULL on success */
+} t_job;
+
+typedef struct t_pool_tag t_pool;
+
+/* A worker of a batch owns a range of jobs. It takes them from the
+ * front, idle workers steal them from the back.
+ */
+typedef struct
+{
+	t_pool      *pool;
+	int         index;
+	bs2b_mutex  lock;
+	int         front;
+	int         back;
+	bs2b_thread thread;
+	int         started;
+} t_worker;
+
+struct t_pool_tag
+{
+	t_job    *job;
+	int      jobs;
+	t_worker *worker;
+	int      workers;
+	uint32_t level;
+	int      block;
+};
+
 static void copy_metadata( SNDFILE *outfile, SNDFILE *infile );
-static void copy_data( SNDFILE *outfile, SNDFILE *infile, t_bs2bdp bs2bdp );
+static sf_count_t copy_data( SNDFILE *outfile, SNDFILE *infile,
+	t_bs2bdp bs2bdp, int format, int block );
+static int  is_wav( int format );
+static int  map_data( SNDFILE *infile, char const *infilename,
+	char const *outfilename, t_bs2bdp bs2bdp, sf_count_t *frames );
+static int  copy_data_parallel( SNDFILE *outfile, SF_INFO const *sfinfo,
+	char const *infilename, t_bs2bdp bs2bdp, int threads );
+static int  convert_batch( char const *source, char const *rule,
+	uint32_t level, int threads, int block );
 
 static void print_usage( char *progname )
 {
@@ -43,8 +199,9 @@ static void print_usage( char *progname )
 		"Bauer stereophonic-to-binaural DSP converter. Version %s\n\n",
 		BS2B_VERSION_STR );
 	printf(
-		"Usage : %s [-l L|(L1 L2)] <input file> <output file>\n",
-		progname );
+		"Usage : %s [-l L|(L1 L2)] [-j N] [-n N] <input file> <output file>\n"
+		"        %s [-l L|(L1 L2)] [-j N] [-n N] -b <list|directory> <rule>\n",
+		progname, progname );
 	printf(
 		"-h - this help.\n"
 		"-l - crossfeed level, L = d|c|m:\n"
@@ -52,9 +209,21 @@ static void print_usage( char *progname )
 		"     c - Chu Moy's preset   - 700Hz/260us, 6.0 dB;\n"
 		"     m - Jan Meier's preset - 650Hz/280us, 9.5 dB.\n"
 		"     Or L1 = [%d..%d] mB of feed level (%d..%d dB)\n"
-		"     and L2 = [%d..%d] Hz of cut frequency.\n",
+		"     and L2 = [%d..%d] Hz of cut frequency.\n"
+		"-j - convert by N threads (0 - one per CPU), default 1.\n"
+		"     Each part of a file starts from a warm-up pre-roll,\n"
+		"     so output differs from one thread by less than %g.\n"
+		"-b - batch mode, files listed one per line ('-' - read from\n"
+		"     stdin) or found in a directory tree are converted by N\n"
+		"     threads of -j. Output names follow the rule with\n"
+		"     %%d - directory (relative to the tree), %%n - name and\n"
+		"     %%e - extension of an input file, e.g. out/%%d/%%n.%%e.\n"
+		"     A thread converts one file at a time by one buffer of\n"
+		"     -n stereo samples, up to 16 bytes each, and a 1 MiB\n"
+		"     copy of misaligned samples of a mapped WAV file.\n"
+		"-n - block of N = [1..%d] stereo samples, default %d.\n",
 		BS2B_MINFEED, BS2B_MAXFEED, BS2B_MINFEED / 10, BS2B_MAXFEED / 10,
-		BS2B_MINFCUT, BS2B_MAXFCUT );
+		BS2B_MINFCUT, BS2B_MAXFCUT, SETTLE_EPS, BLOCK_MAX, BLOCK_LEN );
 } /* print_usage() */
 
 int main( int argc, char *argv[] )
@@ -65,6 +234,9 @@ int main( int argc, char *argv[] )
 	t_bs2bdp bs2bdp;
 	uint32_t srate = BS2B_DEFAULT_SRATE;
 	uint32_t level = BS2B_DEFAULT_CLEVEL;
+	int threads = 1;
+	int batch = 0;
+	int block = BLOCK_LEN;
 	int i;
 
 	tmpstr = strrchr( argv[ 0 ], '/' );
@@ -132,6 +304,34 @@ int main( int argc, char *argv[] )
 				} /* switch */
 				break;
 
+			case 'b':
+				batch = 1;
+				break;
+
+			case 'j':
+				if( ++i >= argc )
+				{
+					print_usage( progname );
+					return 1;
+				}
+				threads = atoi( argv[ i ] );
+				if( threads <= 0 ) threads = bs2b_cpu_count();
+				break;
+
+			case 'n':
+				if( ++i >= argc )
+				{
+					print_usage( progname );
+					return 1;
+				}
+				block = atoi( argv[ i ] );
+				if( block < 1 || block > BLOCK_MAX )
+				{
+					print_usage( progname );
+					return 1;
+				}
+				break;
+
 			default:
 				print_usage( progname );
 				return 1;
@@ -144,6 +344,10 @@ int main( int argc, char *argv[] )
 		}
 	} /* for */
 
+	if( batch )
+		return convert_batch( infilename, outfilename, level, threads,
+			block );
+
 	if( strcmp( infilename, outfilename ) == 0 )
 	{
 		printf( "Error : Input and output filenames are the same.\n\n" );
@@ -173,20 +377,10 @@ int main( int argc, char *argv[] )
 		return 1;
 	}
 
-	/* Open the output file. */
-	if( ( outfile = sf_open( outfilename, SFM_WRITE, &sfinfo ) ) == NULL )
-	{
-		printf( "Not able to open output file %s : %s\n",
-			outfilename, sf_strerror( NULL ) );
-		sf_close( infile );
-		return 1;
-	}
-
 	if( NULL == ( bs2bdp = bs2b_open() ) )
 	{
 		printf( "Not able to allocate data\n" );
 		sf_close( infile );
-		sf_close( outfile );
 		return 1;
 	}
 
@@ -199,9 +393,43 @@ int main( int argc, char *argv[] )
 	printf( "Converting file '%s' to file '%s'\nsample rate = %u...",
 		infilename, outfilename, bs2b_get_srate( bs2bdp ) );
 
+	/* Plain PCM WAV is converted in one thread with no libsndfile */
+	if( threads <= 1 && is_wav( sfinfo.format ) &&
+		0 == map_data( infile, infilename, outfilename, bs2bdp, NULL ) )
+	{
+		bs2b_close( bs2bdp );
+		sf_close( infile );
+		printf( " Done.\n" );
+		return 0;
+	}
+
+	/* Open the output file. */
+	if( ( outfile = sf_open( outfilename, SFM_WRITE, &sfinfo ) ) == NULL )
+	{
+		printf( "\nNot able to open output file %s : %s\n",
+			outfilename, sf_strerror( NULL ) );
+		bs2b_close( bs2bdp );
+		sf_close( infile );
+		return 1;
+	}
+
 	copy_metadata( outfile, infile );
 
-	copy_data( outfile, infile, bs2bdp );
+	if( threads > 1 && sfinfo.seekable &&
+		sfinfo.frames >= PART_MIN_FRAMES * 2 )
+	{
+		if( copy_data_parallel( outfile, &sfinfo, infilename, bs2bdp,
+			threads ) )
+		{
+			printf( " Error : not able to convert by threads.\n" );
+			bs2b_close( bs2bdp );
+			sf_close( infile );
+			sf_close( outfile );
+			return 1;
+		}
+	}
+	else
+		copy_data( outfile, infile, bs2bdp, sfinfo.format, block );
 
 	bs2b_close( bs2bdp );
 	bs2bdp = 0;
@@ -229,16 +457,1481 @@ static void copy_metadata( SNDFILE *outfile, SNDFILE *infile )
 	err = sf_set_string( outfile, SF_STR_COMMENT, "CROSSFEEDED" );
 } /* copy_metadata() */
 
-static void copy_data( SNDFILE *outfile, SNDFILE *infile, t_bs2bdp bs2bdp )
+/* Return IO_* type in which samples of a file 'format' are decoded
+ * and encoded by libsndfile with no loss of precision
+ */
+static int io_type( int format )
+{
+	switch( format & SF_FORMAT_SUBMASK )
+	{
+	case SF_FORMAT_PCM_S8:
+	case SF_FORMAT_PCM_U8:
+	case SF_FORMAT_PCM_16:
+		return IO_SHORT;
+	case SF_FORMAT_PCM_24:
+	case SF_FORMAT_PCM_32:
+		return IO_INT;
+	case SF_FORMAT_FLOAT:
+	case SF_FORMAT_VORBIS:
+		return IO_FLOAT;
+	default:
+		return IO_DOUBLE;
+	} /* switch */
+} /* io_type() */
+
+static size_t io_size( int io )
+{
+	switch( io )
+	{
+	case IO_SHORT: return sizeof( short );
+	case IO_INT:   return sizeof( int );
+	case IO_FLOAT: return sizeof( float );
+	default:       return sizeof( double );
+	} /* switch */
+} /* io_size() */
+
+static sf_count_t read_samples( SNDFILE *infile, int io, void *data,
+	sf_count_t n )
+{
+	switch( io )
+	{
+	case IO_SHORT: return sf_read_short( infile, ( short * )data, n );
+	case IO_INT:   return sf_read_int( infile, ( int * )data, n );
+	case IO_FLOAT: return sf_read_float( infile, ( float * )data, n );
+	default:       return sf_read_double( infile, ( double * )data, n );
+	} /* switch */
+} /* read_samples() */
+
+static sf_count_t write_samples( SNDFILE *outfile, int io, void *data,
+	sf_count_t n )
+{
+	switch( io )
+	{
+	case IO_SHORT: return sf_write_short( outfile, ( short * )data, n );
+	case IO_INT:   return sf_write_int( outfile, ( int * )data, n );
+	case IO_FLOAT: return sf_write_float( outfile, ( float * )data, n );
+	default:       return sf_write_double( outfile, ( double * )data, n );
+	} /* switch */
+} /* write_samples() */
+
+/* Crossfeeds 'n' stereo samples of IO_* type, full scale of integers
+ * is of libsndfile
+ */
+static void cross_feed_samples( t_bs2bdp bs2bdp, int io, void *data, int n )
+{
+	switch( io )
+	{
+	case IO_SHORT:
+		bs2b_cross_feed_s16( bs2bdp, ( int16_t * )data, n );
+		break;
+	case IO_INT:
+		bs2b_cross_feed_s32( bs2bdp, ( int32_t * )data, n );
+		break;
+	case IO_FLOAT:
+		bs2b_cross_feed_f( bs2bdp, ( float * )data, n );
+		break;
+	default:
+		bs2b_cross_feed_d( bs2bdp, ( double * )data, n );
+	} /* switch */
+} /* cross_feed_samples() */
+
+/* Allocates 'size' bytes aligned by BLOCK_ALIGN, an offset to
+ * the allocated block is kept right before them
+ */
+static void *malloc_aligned( size_t size )
+{
+	char   *memory = ( char * )malloc( size + BLOCK_ALIGN );
+	size_t offset;
+
+	if( NULL == memory ) return NULL;
+
+	offset = BLOCK_ALIGN - ( ( size_t )memory & ( BLOCK_ALIGN - 1 ) );
+	memory[ offset - 1 ] = ( char )offset;
+
+	return memory + offset;
+} /* malloc_aligned() */
+
+static void free_aligned( void *ptr )
+{
+	if( ptr )
+		free( ( char * )ptr - ( ( unsigned char * )ptr )[ -1 ] );
+} /* free_aligned() */
+
+/* Return 0 on success */
+static int signal_init( t_signal *sig )
+{
+#ifdef _WIN32
+	*sig = CreateEventA( NULL, FALSE, FALSE, NULL );
+	return NULL == *sig;
+#else
+	sig->raised = 0;
+	if( pthread_mutex_init( &sig->lock, NULL ) ) return 1;
+	if( pthread_cond_init( &sig->cond, NULL ) )
+	{
+		pthread_mutex_destroy( &sig->lock );
+		return 1;
+	}
+	return 0;
+#endif
+} /* signal_init() */
+
+static void signal_destroy( t_signal *sig )
+{
+#ifdef _WIN32
+	CloseHandle( *sig );
+#else
+	pthread_cond_destroy( &sig->cond );
+	pthread_mutex_destroy( &sig->lock );
+#endif
+} /* signal_destroy() */
+
+static void signal_raise( t_signal *sig )
+{
+#ifdef _WIN32
+	SetEvent( *sig );
+#else
+	pthread_mutex_lock( &sig->lock );
+	sig->raised = 1;
+	pthread_cond_signal( &sig->cond );
+	pthread_mutex_unlock( &sig->lock );
+#endif
+} /* signal_raise() */
+
+/* Sleeps until the sig is raised and resets it */
+static void signal_wait( t_signal *sig )
+{
+#ifdef _WIN32
+	WaitForSingleObject( *sig, INFINITE );
+#else
+	pthread_mutex_lock( &sig->lock );
+	while( !sig->raised )
+		pthread_cond_wait( &sig->cond, &sig->lock );
+	sig->raised = 0;
+	pthread_mutex_unlock( &sig->lock );
+#endif
+} /* signal_wait() */
+
+/* Every queue has room for all buffers, so pushes never wait.
+ * A push costs a lock of the signal, once per block.
+ */
+static void pipe_push( t_queue *queue, int buffer )
+{
+	int head = bs2b_atomic_load( &queue->head );
+
+	queue->slot[ head & ( PIPE_BUFFERS - 1 ) ] = buffer;
+	bs2b_atomic_store( &queue->head, head + 1 );
+	signal_raise( &queue->pushed );
+} /* pipe_push() */
+
+/* Yields a few times, as the other stage is often about to push,
+ * then sleeps until a push. A raise left from a push already seen
+ * only costs one more check.
+ */
+static int pipe_pop( t_queue *queue )
+{
+	int tail = bs2b_atomic_load( &queue->tail );
+	int spins = 0;
+	int buffer;
+
+	while( bs2b_atomic_load( &queue->head ) == tail )
+	{
+		if( ++spins < 64 )
+		{
+#ifdef _WIN32
+			Sleep( 0 );
+#else
+			sched_yield();
+#endif
+		}
+		else
+			signal_wait( &queue->pushed );
+	}
+
+	buffer = queue->slot[ tail & ( PIPE_BUFFERS - 1 ) ];
+	bs2b_atomic_store( &queue->tail, tail + 1 );
+
+	return buffer;
+} /* pipe_pop() */
+
+static BS2B_THREAD_PROC( pipe_reader, arg )
+{
+	t_pipe *pipe = ( t_pipe * )arg;
+	int    buffer, count;
+
+	do
+	{
+		buffer = pipe_pop( &pipe->empty );
+		count = ( int )read_samples( pipe->infile, pipe->io,
+			pipe->data[ buffer ], pipe->len );
+		pipe->count[ buffer ] = count = count < 2 ? 0 : count;
+		pipe_push( &pipe->full, buffer );
+	}
+	while( count );
+
+	return BS2B_THREAD_RETURN;
+} /* pipe_reader() */
+
+static BS2B_THREAD_PROC( pipe_writer, arg )
 {
-	static double data[ BUFFER_LEN ];
+	t_pipe *pipe = ( t_pipe * )arg;
+	int    buffer;
+
+	for( ;; )
+	{
+		buffer = pipe_pop( &pipe->done );
+		if( 0 == pipe->count[ buffer ] ) break;
+		write_samples( pipe->outfile, pipe->io, pipe->data[ buffer ],
+			pipe->count[ buffer ] );
+		pipe_push( &pipe->empty, buffer );
+	}
+
+	return BS2B_THREAD_RETURN;
+} /* pipe_writer() */
+
+/* Converts in one thread by 'n' samples of 'data' */
+static sf_count_t copy_data_serial( SNDFILE *outfile, SNDFILE *infile,
+	t_bs2bdp bs2bdp, int io, void *data, int n )
+{
+	sf_count_t frames = 0;
 	int readcount;
 
 	for( ;; )
 	{
-		readcount = ( int )sf_read_double( infile, data, BUFFER_LEN );
+		readcount = ( int )read_samples( infile, io, data, n );
 		if( readcount < 2 ) break;
-		bs2b_cross_feed_d( bs2bdp, data, readcount / 2 );
-		sf_write_double( outfile, data, readcount );
+		cross_feed_samples( bs2bdp, io, data, readcount / 2 );
+		write_samples( outfile, io, data, readcount );
+		frames += readcount / 2;
+	}
+
+	return frames;
+} /* copy_data_serial() */
+
+/* Reads and decodes, crossfeeds and encodes and writes by three
+ * stages at once, so it takes as long as the slowest of them.
+ * Samples stay in a type of 'format' of the file by 'block' stereo
+ * samples. Return a number of converted stereo samples.
+ */
+static sf_count_t copy_data( SNDFILE *outfile, SNDFILE *infile,
+	t_bs2bdp bs2bdp, int format, int block )
+{
+	t_pipe      pipe;
+	t_queue     *queue[ 3 ];
+	bs2b_thread reader, writer;
+	double      data[ BUFFER_LEN ];
+	char        *memory;
+	size_t      size;
+	sf_count_t  frames = 0;
+	int         i, k, buffer, count;
+
+	memset( &pipe, 0, sizeof( pipe ) );
+	pipe.infile = infile;
+	pipe.outfile = outfile;
+	pipe.io = io_type( format );
+	pipe.len = block * 2;
+
+	/* Every buffer is aligned */
+	size = ( pipe.len * io_size( pipe.io ) + BLOCK_ALIGN - 1 ) &
+		~( size_t )( BLOCK_ALIGN - 1 );
+
+	queue[ 0 ] = &pipe.empty;
+	queue[ 1 ] = &pipe.full;
+	queue[ 2 ] = &pipe.done;
+
+	for( k = 0; k < 3; k++ )
+		if( signal_init( &queue[ k ]->pushed ) ) break;
+
+	memory = k < 3 ? NULL :
+		( char * )malloc_aligned( size * PIPE_BUFFERS );
+	if( NULL == memory )
+	{
+		while( k-- ) signal_destroy( &queue[ k ]->pushed );
+		return copy_data_serial( outfile, infile, bs2bdp, pipe.io, data,
+			BUFFER_LEN * sizeof( double ) / io_size( pipe.io ) );
+	}
+
+	for( i = 0; i < PIPE_BUFFERS; i++ )
+	{
+		pipe.data[ i ] = memory + size * i;
+		pipe_push( &pipe.empty, i );
+	}
+
+	if( bs2b_thread_create( &writer, pipe_writer, &pipe ) )
+		frames = copy_data_serial( outfile, infile, bs2bdp, pipe.io, memory,
+			pipe.len );
+	else if( bs2b_thread_create( &reader, pipe_reader, &pipe ) )
+	{
+		/* Stops the writer before any data */
+		pipe.count[ 0 ] = 0;
+		pipe_push( &pipe.done, 0 );
+		bs2b_thread_join( writer );
+		frames = copy_data_serial( outfile, infile, bs2bdp, pipe.io, memory,
+			pipe.len );
 	}
+	else
+	{
+		/* A pushed buffer belongs to the next stage, its count is kept */
+		do
+		{
+			buffer = pipe_pop( &pipe.full );
+			count = pipe.count[ buffer ];
+			cross_feed_samples( bs2bdp, pipe.io, pipe.data[ buffer ],
+				count / 2 );
+			frames += count / 2;
+			pipe_push( &pipe.done, buffer );
+		}
+		while( count );
+
+		bs2b_thread_join( reader );
+		bs2b_thread_join( writer );
+	}
+
+	for( k = 0; k < 3; k++ )
+		signal_destroy( &queue[ k ]->pushed );
+
+	free_aligned( memory );
+
+	return frames;
 } /* copy_data() */
+
+/* Return 1 for WAV files libsndfile may store as plain PCM */
+static int is_wav( int format )
+{
+	return SF_FORMAT_WAV == ( format & SF_FORMAT_TYPEMASK ) ||
+		SF_FORMAT_WAVEX == ( format & SF_FORMAT_TYPEMASK );
+} /* is_wav() */
+
+/* Maps a whole file to memory. A new writable file gets '*size' bytes
+ * reserved on a disk, otherwise '*size' is set to a file size.
+ * Return NULL on error.
+ */
+static void *map_file( char const *filename, size_t *size, int writable )
+{
+	void *addr = NULL;
+#ifdef _WIN32
+	HANDLE        file, map;
+	LARGE_INTEGER len;
+
+	file = writable ?
+		CreateFileA( filename, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+			CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL ) :
+		CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if( INVALID_HANDLE_VALUE == file ) return NULL;
+
+	if( writable )
+		len.QuadPart = ( LONGLONG )*size;
+	else if( !GetFileSizeEx( file, &len ) ||
+		( LONGLONG )( size_t )len.QuadPart != len.QuadPart )
+		len.QuadPart = 0;
+
+	if( len.QuadPart > 0 )
+	{
+		map = CreateFileMappingA( file, NULL,
+			writable ? PAGE_READWRITE : PAGE_READONLY,
+			( DWORD )( len.QuadPart >> 32 ), ( DWORD )len.QuadPart, NULL );
+		if( map )
+		{
+			addr = MapViewOfFile( map, writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+				0, 0, ( size_t )len.QuadPart );
+			CloseHandle( map );
+		}
+	}
+
+	CloseHandle( file );
+
+	if( addr ) *size = ( size_t )len.QuadPart;
+#else
+	struct stat st;
+	int         fd;
+
+	fd = writable ? open( filename, O_RDWR | O_CREAT | O_TRUNC, 0666 ) :
+		open( filename, O_RDONLY );
+	if( fd < 0 ) return NULL;
+
+	if( writable )
+	{
+		/* Pages of a sparse file would fault on a full disk,
+		 * so files are not mapped for writing if space can't be reserved
+		 */
+#ifdef HAVE_POSIX_FALLOCATE
+		if( *size > 0 && ( off_t )*size > 0 &&
+			0 == posix_fallocate( fd, 0, ( off_t )*size ) )
+			addr = mmap( NULL, *size, PROT_READ | PROT_WRITE, MAP_SHARED,
+				fd, 0 );
+#endif
+	}
+	else if( 0 == fstat( fd, &st ) && st.st_size > 0 &&
+		( off_t )( size_t )st.st_size == st.st_size )
+	{
+		*size = ( size_t )st.st_size;
+		addr = mmap( NULL, *size, PROT_READ, MAP_SHARED, fd, 0 );
+		if( MAP_FAILED != addr )
+			madvise( addr, *size, MADV_SEQUENTIAL );
+	}
+
+	close( fd );
+
+	if( MAP_FAILED == addr ) addr = NULL;
+#endif
+
+	return addr;
+} /* map_file() */
+
+static void unmap_file( void *addr, size_t size )
+{
+#ifdef _WIN32
+	( void )size;
+	UnmapViewOfFile( addr );
+#else
+	munmap( addr, size );
+#endif
+} /* unmap_file() */
+
+static uint32_t get_le16( unsigned char const *p )
+{
+	return p[ 0 ] | ( ( uint32_t )p[ 1 ] << 8 );
+} /* get_le16() */
+
+static uint32_t get_le32( unsigned char const *p )
+{
+	return get_le16( p ) | ( get_le16( p + 2 ) << 16 );
+} /* get_le32() */
+
+static void put_le32( unsigned char *p, uint32_t v )
+{
+	p[ 0 ] = ( unsigned char )v;
+	p[ 1 ] = ( unsigned char )( v >> 8 );
+	p[ 2 ] = ( unsigned char )( v >> 16 );
+	p[ 3 ] = ( unsigned char )( v >> 24 );
+} /* put_le32() */
+
+/* Return a native value of a little endian WAV_F32 or WAV_F64 sample */
+static double get_float( unsigned char const *p, int type )
+{
+	unsigned char  b[ 8 ];
+	uint16_t const one = 1;
+	size_t         size = wav_bytes[ type ], i;
+	float          f;
+	double         d;
+
+	for( i = 0; i < size; i++ )
+		b[ i ] = p[ *( unsigned char const * )&one ? i : size - 1 - i ];
+
+	if( WAV_F32 == type )
+	{
+		memcpy( &f, b, sizeof( f ) );
+		return f;
+	}
+
+	memcpy( &d, b, sizeof( d ) );
+	return d;
+} /* get_float() */
+
+/* Writes a chunk 'id' of 'len' bytes of 'data' to 'out', only a header
+ * if 'data' is NULL and nothing if 'out' is NULL.
+ * Return a size of the chunk with a pad byte.
+ */
+static size_t put_chunk( unsigned char *out, char const *id,
+	void const *data, size_t len )
+{
+	if( out )
+	{
+		memcpy( out, id, 4 );
+		put_le32( out + 4, ( uint32_t )len );
+		if( data ) memcpy( out + 8, data, len );
+		if( len & 1 ) out[ 8 + len ] = 0;
+	}
+
+	return 8 + len + ( len & 1 );
+} /* put_chunk() */
+
+/* LIST INFO ids of strings of WAV files by libsndfile */
+static struct
+{
+	int        str;
+	char const *id;
+} const info_ids[] =
+{
+	{ SF_STR_TITLE,     "INAM" },
+	{ SF_STR_COPYRIGHT, "ICOP" },
+	{ SF_STR_SOFTWARE,  "ISFT" },
+	{ SF_STR_ARTIST,    "IART" },
+	{ SF_STR_COMMENT,   "ICMT" },
+	{ SF_STR_DATE,      "ICRD" },
+	{ SF_STR_ALBUM,     "IPRD" }
+};
+
+/* Writes a LIST INFO chunk of strings of 'infile' as copy_metadata()
+ * sets them to 'out' if it is not NULL. Return a size of the chunk.
+ */
+static size_t put_info( unsigned char *out, SNDFILE *infile )
+{
+	char const *str;
+	size_t     size = 12;
+	size_t     i;
+
+	for( i = 0; i < sizeof( info_ids ) / sizeof( info_ids[ 0 ] ); i++ )
+	{
+		str = SF_STR_COMMENT == info_ids[ i ].str ? "CROSSFEEDED" :
+			sf_get_string( infile, info_ids[ i ].str );
+		if( str != NULL )
+			size += put_chunk( out ? out + size : NULL, info_ids[ i ].id,
+				str, strlen( str ) + 1 );
+	}
+
+	if( out )
+	{
+		put_chunk( out, "LIST", NULL, size - 8 );
+		memcpy( out + 8, "INFO", 4 );
+	}
+
+	return size;
+} /* put_info() */
+
+/* Finds data of a stereo PCM WAV file 'wav' of 'size' bytes.
+ * 'fmt' is set to an offset of a body of its fmt chunk, 'fmt_len' to
+ * a length of the body without extra bytes of non-extensible formats.
+ * Return WAV_* type of samples or -1 if a file is not such one.
+ */
+static int find_wav_data( unsigned char const *wav, size_t size,
+	uint32_t *srate, size_t *fmt, size_t *fmt_len, size_t *offset,
+	size_t *frames )
+{
+	size_t   pos, len;
+	uint32_t tag = 0, channels = 0, align = 0, bits = 0;
+	int      type = -1;
+
+	if( size < 12 || memcmp( wav, "RIFF", 4 ) || memcmp( wav + 8, "WAVE", 4 ) )
+		return -1;
+
+	for( pos = 12; pos + 8 <= size; pos += 8 + len + ( len & 1 ) )
+	{
+		len = get_le32( wav + pos + 4 );
+
+		if( 0 == memcmp( wav + pos, "data", 4 ) )
+		{
+			if( !align ) return -1;
+
+			/* Length of streamed files may be unknown */
+			if( len > size - pos - 8 ) len = size - pos - 8;
+
+			*offset = pos + 8;
+			*frames = len / align;
+			break;
+		}
+
+		if( len > size - pos - 8 ) return -1;
+
+		if( 0 == memcmp( wav + pos, "fmt ", 4 ) )
+		{
+			if( len < 16 ) return -1;
+
+			tag      = get_le16( wav + pos + 8 );
+			channels = get_le16( wav + pos + 10 );
+			*srate   = get_le32( wav + pos + 12 );
+			align    = get_le16( wav + pos + 20 );
+			bits     = get_le16( wav + pos + 22 );
+			*fmt     = pos + 8;
+			*fmt_len = 16;
+
+			/* WAVE_FORMAT_EXTENSIBLE, samples must be of all 'bits' */
+			if( 0xfffe == tag )
+			{
+				if( len < 40 || get_le16( wav + pos + 26 ) != bits )
+					return -1;
+				tag = get_le16( wav + pos + 32 );
+				*fmt_len = 40;
+			}
+		}
+	} /* for */
+
+	if( pos + 8 > size || 2 != channels || align != bits / 4 )
+		return -1;
+
+	if( 1 == tag ) /* WAVE_FORMAT_PCM */
+	{
+		switch( bits )
+		{
+		case 8:  type = WAV_U8;  break;
+		case 16: type = WAV_S16; break;
+		case 24: type = WAV_S24; break;
+		case 32: type = WAV_S32; break;
+		} /* switch */
+	}
+	else if( 3 == tag ) /* WAVE_FORMAT_IEEE_FLOAT */
+	{
+		switch( bits )
+		{
+		case 32: type = WAV_F32; break;
+		case 64: type = WAV_F64; break;
+		} /* switch */
+	}
+
+	return type;
+} /* find_wav_data() */
+
+/* Crossfeeds 'n' stereo samples of WAV_* 'type' from 'in' to 'out' */
+static void cross_feed_wav( t_bs2bdp bs2bdp, int type,
+	void const *in, void *out, size_t n )
+{
+	switch( type )
+	{
+	case WAV_U8:
+		bs2b_cross_feed_u8_to( bs2bdp, ( uint8_t const * )in,
+			( uint8_t * )out, n );
+		break;
+	case WAV_S16:
+		bs2b_cross_feed_s16le_to( bs2bdp, ( int16_t const * )in,
+			( int16_t * )out, n );
+		break;
+	case WAV_S24:
+		bs2b_cross_feed_s24le_to( bs2bdp, ( bs2b_int24_t const * )in,
+			( bs2b_int24_t * )out, n );
+		break;
+	case WAV_S32:
+		bs2b_cross_feed_s32le_to( bs2bdp, ( int32_t const * )in,
+			( int32_t * )out, n );
+		break;
+	case WAV_F32:
+		bs2b_cross_feed_fle_to( bs2bdp, ( float const * )in,
+			( float * )out, n );
+		break;
+	case WAV_F64:
+		bs2b_cross_feed_dle_to( bs2bdp, ( double const * )in,
+			( double * )out, n );
+		break;
+	} /* switch */
+} /* cross_feed_wav() */
+
+/* Crossfeeds a stereo PCM WAV file from a memory map of it to a memory
+ * map of a new file. The new file has chunks as libsndfile writes them:
+ * fmt, fact and PEAK of floats, data and LIST INFO of strings of
+ * 'infile' by copy_metadata(). Sample rate must be set.
+ * Return 0 on success or 1 if the file is to be converted by libsndfile,
+ * nothing is crossfed then.
+ */
+static int map_data( SNDFILE *infile, char const *infilename,
+	char const *outfilename, t_bs2bdp bs2bdp, sf_count_t *frames )
+{
+	unsigned char *in, *out, *data, *peak_chunk = NULL;
+	void          *bounce = NULL;
+	size_t        in_size, out_size, fmt = 0, fmt_len = 0, offset = 0;
+	size_t        n = 0, head, frame, done, m, i, at[ 2 ] = { 0, 0 };
+	double        peak[ 2 ] = { 0.0, 0.0 }, v;
+	uint32_t      srate = 0;
+	float         f;
+	int           type, is_float, misaligned, c;
+
+	in = ( unsigned char * )map_file( infilename, &in_size, 0 );
+	if( NULL == in ) return 1;
+
+	type = find_wav_data( in, in_size, &srate, &fmt, &fmt_len, &offset,
+		&n );
+	is_float = WAV_F32 == type || WAV_F64 == type;
+	frame = type < 0 ? 0 : wav_bytes[ type ] * 2;
+
+	/* Headers of fmt, fact and PEAK of floats and data, samples of all
+	 * types are aligned after them
+	 */
+	head = 12 + put_chunk( NULL, "fmt ", NULL, fmt_len ) +
+		( is_float ? put_chunk( NULL, "fact", NULL, 4 ) +
+		put_chunk( NULL, "PEAK", NULL, 8 + 2 * 8 ) : 0 ) + 8;
+
+	out_size = head + n * frame + put_info( NULL, infile );
+
+	/* Misaligned input samples are crossfed from a copy */
+	misaligned = type >= 0 && WAV_S24 != type && offset % wav_bytes[ type ];
+	if( misaligned )
+		bounce = malloc_aligned( MAP_FRAMES * frame );
+
+	if( type < 0 || srate != bs2b_get_srate( bs2bdp ) ||
+		( misaligned && NULL == bounce ) ||
+		( out_size - 8 ) / 2 > 0x7fffffffUL )
+	{
+		free_aligned( bounce );
+		unmap_file( in, in_size );
+		return 1;
+	}
+
+	out = ( unsigned char * )map_file( outfilename, &out_size, 1 );
+	if( NULL == out )
+	{
+		free_aligned( bounce );
+		unmap_file( in, in_size );
+		return 1;
+	}
+
+	memcpy( out, "RIFF", 4 );
+	put_le32( out + 4, ( uint32_t )( out_size - 8 ) );
+	memcpy( out + 8, "WAVE", 4 );
+	data = out + 12;
+	data += put_chunk( data, "fmt ", in + fmt, fmt_len );
+	if( 40 == fmt_len )
+	{
+		/* cbSize of the extension kept */
+		data[ 16 - 40 ] = 22;
+		data[ 17 - 40 ] = 0;
+	}
+	if( is_float )
+	{
+		data += put_chunk( data, "fact", NULL, 4 );
+		put_le32( data - 4, ( uint32_t )n );
+		peak_chunk = data;
+		data += put_chunk( data, "PEAK", NULL, 8 + 2 * 8 );
+	}
+	put_chunk( data, "data", NULL, n * frame );
+	data = out + head;
+
+	for( done = 0; done < n; done += m )
+	{
+		m = n - done < MAP_FRAMES ? n - done : MAP_FRAMES;
+
+		if( bounce )
+			memcpy( bounce, in + offset + done * frame, m * frame );
+
+		cross_feed_wav( bs2bdp, type,
+			bounce ? bounce : in + offset + done * frame,
+			data + done * frame, m );
+
+		/* Peaks of floats while the block is in cache */
+		for( i = 0; is_float && i < m * 2; i++ )
+		{
+			v = get_float( data + done * frame + i * frame / 2, type );
+			if( v < 0.0 ) v = -v;
+			if( v > peak[ i & 1 ] )
+			{
+				peak[ i & 1 ] = v;
+				at[ i & 1 ] = done + i / 2;
+			}
+		}
+	} /* for */
+
+	if( peak_chunk )
+	{
+		put_le32( peak_chunk + 8, 1 );
+		put_le32( peak_chunk + 12, ( uint32_t )time( NULL ) );
+		for( c = 0; c < 2; c++ )
+		{
+			uint32_t bits;
+
+			f = ( float )peak[ c ];
+			memcpy( &bits, &f, sizeof( bits ) );
+			put_le32( peak_chunk + 16 + c * 8, bits );
+			put_le32( peak_chunk + 20 + c * 8, ( uint32_t )at[ c ] );
+		}
+	}
+
+	put_info( out + head + n * frame, infile );
+
+	unmap_file( out, out_size );
+	unmap_file( in, in_size );
+	free_aligned( bounce );
+
+	if( frames ) *frames = ( sf_count_t )n;
+
+	return 0;
+} /* map_data() */
+
+/* Converts a part from its pre-roll by a separate handle of the input
+ * file and instance.
+ */
+static BS2B_THREAD_PROC( convert_part, arg )
+{
+	t_part     *part = ( t_part * )arg;
+	double     data[ BUFFER_LEN ];
+	SF_INFO    sfinfo;
+	SNDFILE    *infile;
+	t_bs2bdp   bs2bdp;
+	sf_count_t left, count, readcount;
+
+	memset( &sfinfo, 0, sizeof( sfinfo ) );
+	infile = sf_open( part->infilename, SFM_READ, &sfinfo );
+	bs2bdp = bs2b_open();
+
+	if( NULL == infile || NULL == bs2bdp ||
+		sf_seek( infile, part->start - part->preroll, SEEK_SET ) < 0 )
+		part->error = 1;
+	else
+		bs2b_configure( bs2bdp, part->srate, part->level );
+
+	/* Warm-up, output is dropped */
+	for( left = part->preroll; left > 0 && !part->error; left -= count )
+	{
+		count = left < BUFFER_LEN / 2 ? left : BUFFER_LEN / 2;
+
+		if( sf_readf_double( infile, data, count ) < count )
+			part->error = 1;
+		else
+			bs2b_cross_feed_d( bs2bdp, data, ( int )count );
+	}
+
+	for( left = part->frames; !part->error; left -= readcount )
+	{
+		/* The last part is read up to the end of a file,
+		 * a length of some formats is an estimate
+		 */
+		count = part->last || left > BUFFER_LEN / 2 ? BUFFER_LEN / 2 : left;
+		if( count <= 0 ) break;
+
+		readcount = sf_readf_double( infile, data, count );
+		if( readcount < count && !part->last ) part->error = 1;
+		if( readcount <= 0 ) break;
+
+		bs2b_cross_feed_d( bs2bdp, data, ( int )readcount );
+
+		if( part->outfile )
+			sf_writef_double( part->outfile, data, readcount );
+		else if( fwrite( data, sizeof( double ) * 2, ( size_t )readcount,
+			part->tmpfile ) != ( size_t )readcount )
+			part->error = 1;
+	} /* for */
+
+	if( bs2bdp ) bs2b_close( bs2bdp );
+	if( infile ) sf_close( infile );
+
+	return BS2B_THREAD_RETURN;
+} /* convert_part() */
+
+/* Appends a part kept in a temporary file to the output file */
+static int append_part( SNDFILE *outfile, FILE *tmpfile )
+{
+	double data[ BUFFER_LEN ];
+	size_t count;
+
+	rewind( tmpfile );
+
+	while( ( count = fread( data, sizeof( double ) * 2, BUFFER_LEN / 2,
+		tmpfile ) ) > 0 )
+		sf_writef_double( outfile, data, ( sf_count_t )count );
+
+	return ferror( tmpfile ) ? 1 : 0;
+} /* append_part() */
+
+/* Converts parts of a file by up to 'threads' threads and writes them
+ * in order. Return 0 on success.
+ */
+static int copy_data_parallel( SNDFILE *outfile, SF_INFO const *sfinfo,
+	char const *infilename, t_bs2bdp bs2bdp, int threads )
+{
+	t_part     *part;
+	sf_count_t preroll, start;
+	int        count, k, error = 0;
+
+	count = sfinfo->frames / PART_MIN_FRAMES < threads ?
+		( int )( sfinfo->frames / PART_MIN_FRAMES ) : threads;
+
+	if( NULL == ( part = ( t_part * )calloc( count, sizeof( t_part ) ) ) )
+		return 1;
+
+	preroll = ( sf_count_t )bs2b_settle_frames( bs2bdp, SETTLE_EPS );
+
+	for( k = 0, start = 0; k < count; k++ )
+	{
+		part[ k ].infilename = infilename;
+		part[ k ].srate      = bs2b_get_srate( bs2bdp );
+		part[ k ].level      = bs2b_get_level( bs2bdp );
+		part[ k ].start      = start;
+		part[ k ].frames     = sfinfo->frames / count +
+			( k < sfinfo->frames % count );
+		part[ k ].preroll    = start < preroll ? start : preroll;
+		part[ k ].last       = k == count - 1;
+
+		if( 0 == k )
+			part[ k ].outfile = outfile;
+		else if( NULL == ( part[ k ].tmpfile = tmpfile() ) )
+			error = 1;
+
+		start += part[ k ].frames;
+	} /* for */
+
+	if( !error )
+	{
+		for( k = 1; k < count; k++ )
+			part[ k ].started = 0 ==
+				bs2b_thread_create( &part[ k ].thread, convert_part, &part[ k ] );
+
+		convert_part( &part[ 0 ] );
+		error = part[ 0 ].error;
+
+		for( k = 1; k < count; k++ )
+		{
+			if( part[ k ].started )
+				bs2b_thread_join( part[ k ].thread );
+			else
+				convert_part( &part[ k ] );
+
+			if( !error )
+				error = part[ k ].error ||
+					append_part( outfile, part[ k ].tmpfile );
+		} /* for */
+	}
+
+	for( k = 1; k < count; k++ )
+		if( part[ k ].tmpfile ) fclose( part[ k ].tmpfile );
+
+	free( part );
+
+	return error;
+} /* copy_data_parallel() */
+
+/* Wall clock in seconds */
+static double wall_time( void )
+{
+#ifdef _WIN32
+	LARGE_INTEGER count, freq;
+
+	QueryPerformanceCounter( &count );
+	QueryPerformanceFrequency( &freq );
+
+	return ( double )count.QuadPart / ( double )freq.QuadPart;
+#else
+	struct timeval tv;
+
+	gettimeofday( &tv, NULL );
+
+	return tv.tv_sec + tv.tv_usec * 1e-6;
+#endif
+} /* wall_time() */
+
+/* Return a copy of 'n' chars of 'str' or NULL */
+static char *copy_string( char const *str, size_t n )
+{
+	char *copy = ( char * )malloc( n + 1 );
+
+	if( copy )
+	{
+		memcpy( copy, str, n );
+		copy[ n ] = '\0';
+	}
+
+	return copy;
+} /* copy_string() */
+
+/* Return 1 if 'path' is a directory */
+static int is_directory( char const *path )
+{
+#ifdef _WIN32
+	DWORD attr = GetFileAttributesA( path );
+
+	return INVALID_FILE_ATTRIBUTES != attr &&
+		( attr & FILE_ATTRIBUTE_DIRECTORY );
+#else
+	struct stat st;
+
+	return 0 == stat( path, &st ) && S_ISDIR( st.st_mode );
+#endif
+} /* is_directory() */
+
+/* Creates missing directories of a file name, existing ones are fine */
+static void make_dirs( char const *filename )
+{
+	char   *path = copy_string( filename, strlen( filename ) );
+	size_t i;
+
+	if( NULL == path ) return;
+
+	for( i = 1; path[ i ]; i++ )
+	{
+		if( '/' != path[ i ] && '\\' != path[ i ] ) continue;
+
+		path[ i ] = '\0';
+#ifdef _WIN32
+		CreateDirectoryA( path, NULL );
+#else
+		mkdir( path, 0777 );
+#endif
+		path[ i ] = filename[ i ];
+	}
+
+	free( path );
+} /* make_dirs() */
+
+/* Adds a job for 'path', 'root' chars of which are the root of a tree
+ * and are not a part of an output directory. Return 1 on error.
+ */
+static int add_job( t_pool *pool, char const *path, size_t root,
+	char const *rule )
+{
+	char const *name, *ext, *c;
+	char       *out;
+	size_t     dir, len, size;
+	t_job      *job;
+
+	if( 0 == ( pool->jobs & ( pool->jobs - 1 ) ) )
+	{
+		job = ( t_job * )realloc( pool->job,
+			sizeof( t_job ) * ( pool->jobs ? pool->jobs * 2 : 16 ) );
+		if( NULL == job ) return 1;
+		pool->job = job;
+	}
+
+	/* Directory, name and extension of the input file */
+	for( name = c = path + root; *c; c++ )
+		if( '/' == *c || '\\' == *c ) name = c + 1;
+	dir = name > path + root ? ( size_t )( name - path ) - root - 1 : 0;
+	ext = strrchr( name, '.' );
+	len = ext ? ( size_t )( ext - name ) : strlen( name );
+	ext = ext ? ext + 1 : "";
+
+	/* Expanded rule is not longer than that */
+	size = strlen( rule ) * ( strlen( path ) + 1 ) + 2;
+
+	if( NULL == ( out = ( char * )malloc( size ) ) ) return 1;
+
+	for( size = 0, c = rule; *c; c++ )
+	{
+		if( '%' != c[ 0 ] || !c[ 1 ] )
+		{
+			out[ size++ ] = *c;
+			continue;
+		}
+
+		switch( *++c )
+		{
+		case 'd':
+			if( dir )
+			{
+				memcpy( out + size, path + root, dir );
+				size += dir;
+			}
+			else
+				out[ size++ ] = '.';
+			break;
+		case 'n':
+			memcpy( out + size, name, len );
+			size += len;
+			break;
+		case 'e':
+			memcpy( out + size, ext, strlen( ext ) );
+			size += strlen( ext );
+			break;
+		default:
+			out[ size++ ] = *c;
+		} /* switch */
+	} /* for */
+
+	out[ size ] = '\0';
+
+	job = &pool->job[ pool->jobs ];
+	memset( job, 0, sizeof( t_job ) );
+	job->outfilename = out;
+
+	if( NULL == ( job->infilename = copy_string( path, strlen( path ) ) ) )
+	{
+		free( out );
+		return 1;
+	}
+
+	pool->jobs++;
+
+	return 0;
+} /* add_job() */
+
+static int compare_names( void const *a, void const *b )
+{
+	return strcmp( *( char * const * )a, *( char * const * )b );
+} /* compare_names() */
+
+/* Adds jobs for files of a directory tree in order of names.
+ * Return 1 on error.
+ */
+static int add_tree( t_pool *pool, char const *path, size_t root,
+	char const *rule )
+{
+	char   **names = NULL;
+	char   *sub;
+	size_t count = 0, i, len;
+	int    error = 0;
+#ifdef _WIN32
+	WIN32_FIND_DATAA fd;
+	HANDLE           find;
+	char             *mask;
+
+	if( NULL == ( mask = ( char * )malloc( strlen( path ) + 3 ) ) ) return 1;
+	sprintf( mask, "%s\\*", path );
+	find = FindFirstFileA( mask, &fd );
+	free( mask );
+
+	if( INVALID_HANDLE_VALUE == find ) return 1;
+
+	do
+	{
+		char const *name = fd.cFileName;
+#else
+	DIR           *d;
+	struct dirent *de;
+
+	if( NULL == ( d = opendir( path ) ) ) return 1;
+
+	while( NULL != ( de = readdir( d ) ) )
+	{
+		char const *name = de->d_name;
+#endif
+		char **more;
+
+		if( 0 == strcmp( name, "." ) || 0 == strcmp( name, ".." ) )
+			continue;
+
+		if( 0 == count % 16 )
+		{
+			more = ( char ** )realloc( names, sizeof( char * ) *
+				( count + 16 ) );
+			if( NULL == more )
+			{
+				error = 1;
+				break;
+			}
+			names = more;
+		}
+
+		if( NULL == ( names[ count ] = copy_string( name, strlen( name ) ) ) )
+		{
+			error = 1;
+			break;
+		}
+		count++;
+#ifdef _WIN32
+	}
+	while( FindNextFileA( find, &fd ) );
+
+	FindClose( find );
+#else
+	} /* while */
+
+	closedir( d );
+#endif
+
+	qsort( names, count, sizeof( char * ), compare_names );
+
+	for( i = 0; i < count; i++ )
+	{
+		if( !error )
+		{
+			len = strlen( path ) + strlen( names[ i ] ) + 2;
+
+			if( NULL == ( sub = ( char * )malloc( len ) ) )
+				error = 1;
+			else
+			{
+				sprintf( sub, "%s/%s", path, names[ i ] );
+
+				if( is_directory( sub ) )
+					error = add_tree( pool, sub, root, rule );
+				else
+					error = add_job( pool, sub, root, rule );
+
+				free( sub );
+			}
+		}
+
+		free( names[ i ] );
+	}
+
+	free( names );
+
+	return error;
+} /* add_tree() */
+
+/* Adds jobs for files listed one per line. Return 1 on error. */
+static int add_list( t_pool *pool, char const *listname, char const *rule )
+{
+	FILE   *list;
+	char   line[ 4096 ];
+	size_t len;
+	int    error = 0;
+
+	if( 0 == strcmp( listname, "-" ) )
+		list = stdin;
+	else if( NULL == ( list = fopen( listname, "r" ) ) )
+		return 1;
+
+	while( !error && fgets( line, sizeof( line ), list ) )
+	{
+		len = strlen( line );
+		while( len && ( '\n' == line[ len - 1 ] || '\r' == line[ len - 1 ] ) )
+			line[ --len ] = '\0';
+		if( len )
+			error = add_job( pool, line, 0, rule );
+	}
+
+	if( stdin != list ) fclose( list );
+
+	return error;
+} /* add_list() */
+
+/* Orders jobs by output names, jobs of the same name by the list */
+static int compare_outputs( void const *a, void const *b )
+{
+	t_job const *x = *( t_job * const * )a;
+	t_job const *y = *( t_job * const * )b;
+	int         c = strcmp( x->outfilename, y->outfilename );
+
+	return c ? c : ( x < y ? -1 : x > y );
+} /* compare_outputs() */
+
+/* Fails jobs whose output name is taken by an earlier job, two workers
+ * must not write one file. Return 1 on error.
+ */
+static int check_outputs( t_pool *pool )
+{
+	t_job **sorted;
+	int   i;
+
+	if( pool->jobs < 2 ) return 0;
+
+	sorted = ( t_job ** )malloc( sizeof( t_job * ) * pool->jobs );
+	if( NULL == sorted ) return 1;
+
+	for( i = 0; i < pool->jobs; i++ )
+		sorted[ i ] = &pool->job[ i ];
+
+	qsort( sorted, pool->jobs, sizeof( t_job * ), compare_outputs );
+
+	for( i = 1; i < pool->jobs; i++ )
+		if( strcmp( sorted[ i ]->outfilename,
+			sorted[ i - 1 ]->outfilename ) == 0 )
+			sorted[ i ]->error = "output name of another file";
+
+	free( sorted );
+
+	return 0;
+} /* check_outputs() */
+
+/* Converts one file of a batch by 'bs2bdp', clears it before.
+ * Samples go through 'data' of pool->block stereo samples of doubles
+ * in the calling thread, workers start no pipelines of their own.
+ */
+static void convert_job( t_job *job, t_bs2bdp bs2bdp, t_pool const *pool,
+	void *data )
+{
+	SNDFILE *infile, *outfile;
+	SF_INFO sfinfo;
+	double  start = wall_time();
+
+	memset( &sfinfo, 0, sizeof( sfinfo ) );
+
+	if( job->error ) return;
+
+	if( strcmp( job->infilename, job->outfilename ) == 0 )
+	{
+		job->error = "input and output filenames are the same";
+		return;
+	}
+
+	if( NULL == ( infile = sf_open( job->infilename, SFM_READ, &sfinfo ) ) )
+	{
+		job->error = "not able to open";
+		return;
+	}
+
+	job->srate = sfinfo.samplerate;
+
+	if( sfinfo.channels != 2 )
+		job->error = "not a stereo";
+	else if( sfinfo.samplerate < BS2B_MINSRATE ||
+		sfinfo.samplerate > BS2B_MAXSRATE )
+		job->error = "not supported sample rate";
+	else
+	{
+		make_dirs( job->outfilename );
+
+		bs2b_set_srate( bs2bdp, sfinfo.samplerate );
+		bs2b_set_level( bs2bdp, pool->level );
+		bs2b_clear( bs2bdp );
+
+		if( is_wav( sfinfo.format ) &&
+			0 == map_data( infile, job->infilename, job->outfilename,
+			bs2bdp, &job->frames ) )
+			outfile = NULL;
+		else if( NULL == ( outfile = sf_open( job->outfilename, SFM_WRITE,
+			&sfinfo ) ) )
+			job->error = "not able to create";
+
+		if( outfile )
+		{
+			copy_metadata( outfile, infile );
+			job->frames = copy_data_serial( outfile, infile, bs2bdp,
+				io_type( sfinfo.format ), data, pool->block * 2 );
+
+			sf_close( outfile );
+		}
+	}
+
+	sf_close( infile );
+
+	job->seconds = wall_time() - start;
+} /* convert_job() */
+
+/* Return an index of a next job of a worker or -1 if no jobs left */
+static int take_job( t_worker *worker )
+{
+	t_pool   *pool = worker->pool;
+	t_worker *victim;
+	int      i, job = -1;
+
+	bs2b_mutex_lock( &worker->lock );
+	if( worker->front < worker->back )
+		job = worker->front++;
+	bs2b_mutex_unlock( &worker->lock );
+
+	/* Steals from the back of others */
+	for( i = 1; job < 0 && i < pool->workers; i++ )
+	{
+		victim = &pool->worker[ ( worker->index + i ) % pool->workers ];
+
+		bs2b_mutex_lock( &victim->lock );
+		if( victim->front < victim->back )
+			job = --victim->back;
+		bs2b_mutex_unlock( &victim->lock );
+	}
+
+	return job;
+} /* take_job() */
+
+static BS2B_THREAD_PROC( batch_worker, arg )
+{
+	t_worker *worker = ( t_worker * )arg;
+	t_bs2bdp bs2bdp;
+	void     *data;
+	int      job;
+
+	bs2bdp = bs2b_open();
+	data = malloc_aligned( ( size_t )worker->pool->block * 2 *
+		sizeof( double ) );
+
+	if( NULL == bs2bdp || NULL == data )
+	{
+		while( ( job = take_job( worker ) ) >= 0 )
+			worker->pool->job[ job ].error = "not enough memory";
+	}
+	else
+	{
+		while( ( job = take_job( worker ) ) >= 0 )
+			convert_job( &worker->pool->job[ job ], bs2bdp, worker->pool,
+				data );
+	}
+
+	free_aligned( data );
+	bs2b_close( bs2bdp );
+
+	return BS2B_THREAD_RETURN;
+} /* batch_worker() */
+
+/* Converts files of a list or a directory tree 'source' with output names
+ * by 'rule' in 'threads' threads. Return an exit code of the program.
+ */
+static int convert_batch( char const *source, char const *rule,
+	uint32_t level, int threads, int block )
+{
+	t_pool     pool;
+	t_job      *job;
+	double     start, audio = 0.0, wall;
+	int        i, failed = 0, error;
+	size_t     root;
+
+	memset( &pool, 0, sizeof( pool ) );
+	pool.level = level;
+	pool.block = block;
+
+	if( strcmp( source, "-" ) != 0 && is_directory( source ) )
+	{
+		root = strlen( source );
+		while( root && ( '/' == source[ root - 1 ] ||
+			'\\' == source[ root - 1 ] ) )
+			root--;
+		error = add_tree( &pool, source, root + 1, rule );
+	}
+	else
+		error = add_list( &pool, source, rule );
+
+	if( !error )
+		error = check_outputs( &pool );
+
+	if( error )
+	{
+		printf( "Not able to read all of '%s'.\n", source );
+		return 1;
+	}
+
+	if( threads <= 0 )
+		threads = bs2b_cpu_count();
+	if( threads > pool.jobs )
+		threads = pool.jobs;
+
+	pool.workers = threads;
+	pool.worker = ( t_worker * )calloc( threads > 0 ? threads : 1,
+		sizeof( t_worker ) );
+	if( NULL == pool.worker )
+	{
+		printf( "Not enough memory.\n" );
+		return 1;
+	}
+
+	printf( "Converting %d files by %d threads...\n", pool.jobs, threads );
+	fflush( stdout );
+
+	start = wall_time();
+
+	/* Contiguous ranges keep files of a directory on one thread */
+	for( i = 0; i < threads; i++ )
+	{
+		t_worker *worker = &pool.worker[ i ];
+
+		worker->pool = &pool;
+		worker->index = i;
+		worker->front = ( int )( ( double )pool.jobs * i / threads );
+		worker->back = ( int )( ( double )pool.jobs * ( i + 1 ) / threads );
+		bs2b_mutex_init( &worker->lock );
+	}
+
+	for( i = 1; i < threads; i++ )
+		pool.worker[ i ].started = 0 == bs2b_thread_create(
+			&pool.worker[ i ].thread, batch_worker, &pool.worker[ i ] );
+
+	if( threads > 0 )
+		batch_worker( &pool.worker[ 0 ] );
+
+	for( i = 1; i < threads; i++ )
+		if( pool.worker[ i ].started )
+			bs2b_thread_join( pool.worker[ i ].thread );
+		else
+			batch_worker( &pool.worker[ i ] );
+
+	wall = wall_time() - start;
+
+	for( i = 0; i < pool.jobs; i++ )
+	{
+		job = &pool.job[ i ];
+
+		if( job->error )
+		{
+			printf( "%s: %s\n", job->infilename, job->error );
+			failed++;
+		}
+		else
+		{
+			double seconds = ( double )job->frames / job->srate;
+
+			printf( "%s -> %s: %.2f s in %.3f s, %.1fx\n", job->infilename,
+				job->outfilename, seconds, job->seconds,
+				job->seconds > 0.0 ? seconds / job->seconds : 0.0 );
+			audio += seconds;
+		}
+
+		free( job->infilename );
+		free( job->outfilename );
+	}
+
+	printf( "Total: %d files, %d failed, %.2f s of audio in %.3f s"
+		" by %d threads, %.1fx\n", pool.jobs, failed, audio, wall, threads,
+		wall > 0.0 ? audio / wall : 0.0 );
+
+	for( i = 0; i < threads; i++ )
+		bs2b_mutex_destroy( &pool.worker[ i ].lock );
+
+	free( pool.worker );
+	free( pool.job );
+
+	return failed ? 1 : 0;
+} /* convert_batch() */
@@ -0,0 +1,171 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Internal interface between the generic library code and
+ * the block processing kernels. Not installed.
+ */
+
+#ifndef BS2BKERNEL_H
+#define BS2BKERNEL_H
+
+#include "bs2b.h"
+
+/* x86 kernels are compiled with per function target attributes
+ * and picked at run time by CPU features, see bs2b_get_kernel().
+ */
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define BS2B_HAVE_X86
+#define BS2B_TARGET( isa ) __attribute__(( target( isa ) ))
+#elif defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#define BS2B_HAVE_X86
+#define BS2B_TARGET( isa )
+#endif
+
+/* Intrinsics of AVX2 and FMA appeared in Visual C++ 2012,
+ * of AVX-512 in Visual C++ 2017. Older compilers have SSE2 only.
+ */
+#if defined( BS2B_HAVE_X86 ) && \
+	( !defined( _MSC_VER ) || _MSC_VER >= 1700 )
+#define BS2B_HAVE_AVX2
+#endif
+#if defined( BS2B_HAVE_X86 ) && \
+	( !defined( _MSC_VER ) || _MSC_VER >= 1910 )
+#define BS2B_HAVE_AVX512
+#endif
+
+/* Products of Q30 fixed-point values */
+#ifdef _MSC_VER
+typedef __int64   bs2b_int64;
+#else
+typedef long long bs2b_int64;
+#endif
+
+/* Byte swaps of scalars */
+#define BS2B_SWAP16( x ) ( ( uint16_t )( ( ( x ) >> 8 ) | ( ( x ) << 8 ) ) )
+#define BS2B_SWAP32( x ) ( ( ( x ) >> 24 ) | ( ( ( x ) >> 8 ) & 0xff00 ) | \
+	( ( ( x ) << 8 ) & 0xff0000 ) | ( ( x ) << 24 ) )
+
+/* Number of stereo samples converted to doubles per kernel call */
+#define BS2B_BLOCK 256
+
+/* Sample formats of block codecs.
+ * 'X' suffix is a byte swapped (opposite to native endian) format.
+ */
+enum
+{
+	BS2B_FMT_DX,
+	BS2B_FMT_F,
+	BS2B_FMT_FX,
+	BS2B_FMT_S32,
+	BS2B_FMT_S32X,
+	BS2B_FMT_U32,
+	BS2B_FMT_U32X,
+	BS2B_FMT_S16,
+	BS2B_FMT_S16X,
+	BS2B_FMT_U16,
+	BS2B_FMT_U16X,
+	BS2B_FMT_S8,
+	BS2B_FMT_U8,
+	BS2B_FMT_S24,
+	BS2B_FMT_S24X,
+	BS2B_FMT_U24,
+	BS2B_FMT_U24X,
+	BS2B_FMT_COUNT,
+
+	/* Native endian doubles are processed without conversion */
+	BS2B_FMT_D = BS2B_FMT_COUNT
+};
+
+/* Converts 'n' single samples (2 per stereo sample) to/from doubles
+ * with clipping of overloaded samples on encoding.
+ */
+typedef void ( *t_bs2b_decode )( void const *in, double *out, int n );
+typedef void ( *t_bs2b_encode )( double const *in, void *out, int n );
+
+/* Set of kernels for one instruction set.
+ * NULL entries are inherited from the lower instruction set.
+ */
+typedef struct
+{
+	int           id;    /* BS2B_KERNEL_* */
+	char const    *name;
+	/* Crossfeeds 'n' stereo samples of native endian doubles
+	 * from 'in' to 'out', they may be the same buffer.
+	 */
+	void          ( *cross_feed_d )( t_bs2bdp bs2bdp,
+		double const *in, double *out, int n );
+	/* The same by look-ahead steps, BS2B_FLAG_LOOKAHEAD */
+	void          ( *cross_feed_ahead_d )( t_bs2bdp bs2bdp,
+		double const *in, double *out, int n );
+	/* Crossfeeds 'n' stereo samples of native endian floats
+	 * by the single precision engine, BS2B_FLAG_FLOAT
+	 */
+	void          ( *cross_feed_f )( t_bs2bdp bs2bdp,
+		float const *in, float *out, int n );
+	/* Crossfeeds 'n' stereo samples of native endian 16 and 32 bit
+	 * integers by the fixed-point engine, BS2B_FLAG_FIXED
+	 */
+	void          ( *cross_feed_s16q )( t_bs2bdp bs2bdp,
+		int16_t const *in, int16_t *out, int n );
+	void          ( *cross_feed_s32q )( t_bs2bdp bs2bdp,
+		int32_t const *in, int32_t *out, int n );
+	/* Byte swaps 'n' 32 bit words */
+	void          ( *swap32 )( void const *in, void *out, int n );
+	/* Interleaves 'n' stereo samples of planar channels */
+	void          ( *zip_d )( double const *left, double const *right,
+		double *out, int n );
+	void          ( *zip_f )( float const *left, float const *right,
+		float *out, int n );
+	/* Splits 'n' interleaved stereo samples to planar channels */
+	void          ( *unzip_d )( double const *in,
+		double *left, double *right, int n );
+	void          ( *unzip_f )( float const *in,
+		float *left, float *right, int n );
+	/* Turns on flush-to-zero of denormals for the calling thread,
+	 * returns a previous mode for restore_fpu(), BS2B_FLAG_DENORMAL_SAFE
+	 */
+	unsigned int  ( *flush_fpu )( void );
+	void          ( *restore_fpu )( unsigned int mode );
+	/* Return 1 if all 'n' bytes are zeros, BS2B_FLAG_SKIP_SILENCE */
+	int           ( *is_zero )( void const *in, int n );
+	/* Crossfeeds 'n' stereo samples of native endian floats of
+	 * BS2B_BATCH_LANES streams of a batch from 'first' on in place,
+	 * sample[k] points to samples of a stream 'first + k'.
+	 */
+	void          ( *cross_feed_batch_f )( t_bs2b_batchp batch,
+		size_t first, float * const *sample, int n );
+	t_bs2b_decode decode[ BS2B_FMT_COUNT ];
+	t_bs2b_encode encode[ BS2B_FMT_COUNT ];
+} t_bs2b_kernel;
+
+#ifdef BS2B_HAVE_X86
+extern t_bs2b_kernel const bs2b_kernel_sse2;
+#endif /* BS2B_HAVE_X86 */
+#ifdef BS2B_HAVE_AVX2
+extern t_bs2b_kernel const bs2b_kernel_avx2;
+#endif /* BS2B_HAVE_AVX2 */
+#ifdef BS2B_HAVE_AVX512
+extern t_bs2b_kernel const bs2b_kernel_avx512;
+#endif /* BS2B_HAVE_AVX512 */
+
+#endif	/* BS2BKERNEL_H */
@@ -0,0 +1,128 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Prints the preset coefficient tables of "bs2bpresets.h" with "-p",
+ * otherwise checks them against init() bit for bit.
+ * The library source is included to reach its static functions.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bs2b.c"
+
+static struct
+{
+	uint32_t   level;
+	char const *name;
+} const levels[] =
+{
+	{ BS2B_DEFAULT_CLEVEL, "BS2B_DEFAULT_CLEVEL" },
+	{ BS2B_CMOY_CLEVEL,    "BS2B_CMOY_CLEVEL" },
+	{ BS2B_JMEIER_CLEVEL,  "BS2B_JMEIER_CLEVEL" }
+};
+
+static uint32_t const srates[] =
+{
+	44100, 48000, 88200, 96000, 176400, 192000
+};
+
+#define COUNT( a ) ( int )( sizeof( a ) / sizeof( a[ 0 ] ) )
+
+static void print_preset( t_bs2bd const *t, char const *name )
+{
+	printf( "\t{ %lu, %s,\n", ( unsigned long )t->srate, name );
+	printf( "\t\t%.17g, %.17g,\n", t->a0_lo, t->b1_lo );
+	printf( "\t\t%.17g, %.17g, %.17g,\n", t->a0_hi, t->a1_hi, t->b1_hi );
+	printf( "\t\t%.17g,\n", t->gain );
+	printf( "\t\t%ld, %ld, %ld, %ld, %ld, %ld },\n",
+		( long )t->q.a0_lo, ( long )t->q.b1_lo, ( long )t->q.a0_hi,
+		( long )t->q.a1_hi, ( long )t->q.b1_hi, ( long )t->q.gain );
+} /* print_preset() */
+
+/* Return 1 if 'p' matches computed coefficients 't' bit for bit */
+static int check_preset( t_bs2bd const *t, t_bs2b_preset const *p )
+{
+	return
+		0 == memcmp( &t->a0_lo, &p->a0_lo, sizeof( double ) ) &&
+		0 == memcmp( &t->b1_lo, &p->b1_lo, sizeof( double ) ) &&
+		0 == memcmp( &t->a0_hi, &p->a0_hi, sizeof( double ) ) &&
+		0 == memcmp( &t->a1_hi, &p->a1_hi, sizeof( double ) ) &&
+		0 == memcmp( &t->b1_hi, &p->b1_hi, sizeof( double ) ) &&
+		0 == memcmp( &t->gain,  &p->gain,  sizeof( double ) ) &&
+		t->q.a0_lo == p->q_a0_lo && t->q.b1_lo == p->q_b1_lo &&
+		t->q.a0_hi == p->q_a0_hi && t->q.a1_hi == p->q_a1_hi &&
+		t->q.b1_hi == p->q_b1_hi && t->q.gain  == p->q_gain;
+} /* check_preset() */
+
+int main( int argc, char *argv[] )
+{
+	t_bs2bd             t;
+	t_bs2b_preset const *p;
+	int                 print, errors = 0;
+	int                 i, k, n;
+
+	print = argc > 1 && 0 == strcmp( argv[ 1 ], "-p" );
+
+	for( i = 0; i < COUNT( levels ); i++ )
+	{
+		for( k = 0; k < COUNT( srates ); k++ )
+		{
+			memset( &t, 0, sizeof( t ) );
+			t.srate = srates[ k ];
+			t.level = levels[ i ].level;
+			init_coef( &t );
+
+			if( print )
+			{
+				print_preset( &t, levels[ i ].name );
+				continue;
+			}
+
+			p = bs2b_presets;
+			n = COUNT( bs2b_presets );
+
+			while( n > 0 && ( p->srate != t.srate || p->level != t.level ) )
+			{
+				n--;
+				p++;
+			}
+
+			if( 0 == n || !check_preset( &t, p ) )
+			{
+				fprintf( stderr, "bs2bpresets: %s at %lu Hz %s\n",
+					levels[ i ].name, ( unsigned long )t.srate,
+					0 == n ? "is missing" : "differs from init()" );
+				errors++;
+			}
+		}
+	}
+
+	if( !print && COUNT( bs2b_presets ) != COUNT( levels ) * COUNT( srates ) )
+	{
+		fprintf( stderr, "bs2bpresets: unexpected presets\n" );
+		errors++;
+	}
+
+	return errors ? 1 : 0;
+} /* main() */
@@ -0,0 +1,137 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Coefficients of preset crossfeed levels at common sample rates,
+ * init() takes them without any libm call. Printed by "bs2bpresets -p"
+ * and checked against computed ones by "bs2bpresets" on every build.
+ * Not installed.
+ */
+
+#ifndef BS2BPRESETS_H
+#define BS2BPRESETS_H
+
+#include "bs2b.h"
+
+typedef struct
+{
+	uint32_t srate, level;
+	double   a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain;
+	/* Q30 coefficients */
+	int32_t  q_a0_lo, q_b1_lo, q_a0_hi, q_a1_hi, q_b1_hi, q_gain;
+} t_bs2b_preset;
+
+static t_bs2b_preset const bs2b_presets[] =
+{
+	{ 44100, BS2B_DEFAULT_CLEVEL,
+		0.043637767880430861, 0.90507895127087923,
+		0.96984456197866231, -0.86786013631946601, 0.86786013631946601,
+		0.81200566346171699,
+		46855696, 971821124, 1041362669, -931857726, 931857726, 871884442 },
+	{ 48000, BS2B_DEFAULT_CLEVEL,
+		0.040252368159273924, 0.91244288640110838,
+		0.97213835038937368, -0.87791142085689933, 0.87791142085689933,
+		0.81200566346171699,
+		43220651, 979728089, 1043825606, -942650210, 942650210, 871884442 },
+	{ 88200, BS2B_DEFAULT_CLEVEL,
+		0.022362787469805689, 0.95135637448375743,
+		0.98438828308458204, -0.93159011175487794, 0.93159011175487794,
+		0.81200566346171699,
+		24011860, 1021511129, 1056978871, -1000287266, 1000287266, 871884442 },
+	{ 96000, BS2B_DEFAULT_CLEVEL,
+		0.020587142936594891, 0.95521876363538227,
+		0.98561585360115866, -0.9369692742330985, 0.9369692742330985,
+		0.81200566346171699,
+		22105276, 1025658338, 1058296964, -1006063098, 1006063098, 871884442 },
+	{ 176400, BS2B_DEFAULT_CLEVEL,
+		0.011320780896527542, 0.97537499172562214,
+		0.99205587062822465, -0.96518915853571319, 0.96518915853571319,
+		0.81200566346171699,
+		12155596, 1047300923, 1065211880, -1036363968, 1036363968, 871884442 },
+	{ 192000, BS2B_DEFAULT_CLEVEL,
+		0.01041146603140489, 0.97735293708843085,
+		0.99269087753452723, -0.96797173214567511, 0.96797173214567511,
+		0.81200566346171699,
+		11179227, 1049424725, 1065893714, -1039351733, 1039351733, 871884442 },
+	{ 44100, BS2B_CMOY_CLEVEL,
+		0.037788750135520903, 0.90507895127087923,
+		0.97332505730850705, -0.8703033318368556, 0.8703033318368556,
+		0.83861984940563672,
+		40575361, 971821124, 1045099822, -934481087, 934481087, 900461207 },
+	{ 48000, BS2B_CMOY_CLEVEL,
+		0.034857114756685875, 0.91244288640110838,
+		0.97535678845841356, -0.88018184455921622, 0.88018184455921622,
+		0.83861984940563672,
+		37427542, 979728089, 1047281377, -945088059, 945088059, 900461207 },
+	{ 88200, BS2B_CMOY_CLEVEL,
+		0.019365376119735229, 0.95135637448375743,
+		0.9861995261663371, -0.93290049407043174, 0.93290049407043174,
+		0.83861984940563672,
+		20793414, 1021511129, 1058923678, -1001694278, 1001694278, 900461207 },
+	{ 96000, BS2B_CMOY_CLEVEL,
+		0.017827731303005339, 0.95521876363538227,
+		0.98728538595690418, -0.93818007043382468, 0.93818007043382468,
+		0.83861984940563672,
+		19142381, 1025658338, 1060089611, -1007363180, 1007363180, 900461207 },
+	{ 176400, BS2B_CMOY_CLEVEL,
+		0.0098033923689690248, 0.97537499172562214,
+		0.99297995814147078, -0.9658677415000626, 0.9658677415000626,
+		0.83861984940563672,
+		10526312, 1047300923, 1066204111, -1037092591, 1037092591, 900461207 },
+	{ 192000, BS2B_CMOY_CLEVEL,
+		0.009015958137071841, 0.97735293708843085,
+		0.99354128127642694, -0.96859695974839022, 0.96859695974839022,
+		0.83861984940563672,
+		9680811, 1049424725, 1066806828, -1040023066, 1040023066, 900461207 },
+	{ 44100, BS2B_JMEIER_CLEVEL,
+		0.025169038912885286, 0.91154956654347907,
+		0.98198711696928598, -0.88030796167474334, 0.88030796167474334,
+		0.88178622659693651,
+		27025050, 978768894, 1054400638, -945223476, 945223476, 946810751 },
+	{ 48000, BS2B_JMEIER_CLEVEL,
+		0.023209923997577021, 0.91843439691185036,
+		0.98336648775109936, -0.88947360718523927, 0.88947360718523927,
+		0.88178622659693651,
+		24921466, 986161425, 1055881726, -955065013, 955065013, 946810751 },
+	{ 88200, BS2B_JMEIER_CLEVEL,
+		0.012875828315413354, 0.95475104951158818,
+		0.99070661251508041, -0.93824728173053784, 0.93824728173053784,
+		0.88178622659693651,
+		13825315, 1025156133, 1063763125, -1007435348, 1007435348, 946810751 },
+	{ 96000, BS2B_JMEIER_CLEVEL,
+		0.011851776245731397, 0.95834983013086106,
+		0.99143978751316342, -0.94311908430761771, 0.94311908430761771,
+		0.88178622659693651,
+		12725748, 1029020295, 1064550366, -1012666406, 1012666406, 946810751 },
+	{ 176400, BS2B_JMEIER_CLEVEL,
+		0.006512437175137829, 0.97711363183182953,
+		0.99527926544075673, -0.96863165430959253, 0.96863165430959253,
+		0.88178622659693651,
+		6992676, 1049167773, 1068672974, -1040060319, 1040060319, 946810751 },
+	{ 192000, BS2B_JMEIER_CLEVEL,
+		0.0059889111230665816, 0.97895343614027996,
+		0.99565723456557986, -0.97114318424608104, 0.97114318424608104,
+		0.88178622659693651,
+		6430544, 1051143248, 1069078815, -1042757054, 1042757054, 946810751 },
+};
+
+#endif	/* BS2BPRESETS_H */
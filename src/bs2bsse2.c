@@ -0,0 +1,857 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "bs2bkernel.h"
+
+#ifdef BS2B_HAVE_X86
+
+#include <emmintrin.h>
+
+#define SSE2 BS2B_TARGET( "sse2" )
+
+/* Both channels of a filter state share one register:
+ * lane 0 is the first channel, lane 1 is the second one.
+ * The result is bit-exact with the scalar cross_feed_d().
+ */
+static SSE2 void cross_feed_d( t_bs2bdp bs2bdp,
+	double const *in, double *out, int n )
+{
+	__m128d a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain;
+	__m128d asis, lo, hi, x, y;
+
+	if( n <= 0 ) return;
+
+	a0_lo = _mm_set1_pd( bs2bdp->a0_lo );
+	b1_lo = _mm_set1_pd( bs2bdp->b1_lo );
+	a0_hi = _mm_set1_pd( bs2bdp->a0_hi );
+	a1_hi = _mm_set1_pd( bs2bdp->a1_hi );
+	b1_hi = _mm_set1_pd( bs2bdp->b1_hi );
+	gain  = _mm_set1_pd( bs2bdp->gain );
+
+	asis = _mm_loadu_pd( bs2bdp->lfs.asis );
+	lo   = _mm_loadu_pd( bs2bdp->lfs.lo );
+	hi   = _mm_loadu_pd( bs2bdp->lfs.hi );
+
+	while( n-- )
+	{
+		x = _mm_loadu_pd( in );
+
+		/* Lowpass filter */
+		lo = _mm_add_pd( _mm_mul_pd( a0_lo, x ), _mm_mul_pd( b1_lo, lo ) );
+
+		/* Highboost filter */
+		hi = _mm_add_pd(
+			_mm_add_pd( _mm_mul_pd( a0_hi, x ), _mm_mul_pd( a1_hi, asis ) ),
+			_mm_mul_pd( b1_hi, hi ) );
+		asis = x;
+
+		/* Crossfeed, lowpassed channels are swapped */
+		y = _mm_add_pd( hi, _mm_shuffle_pd( lo, lo, 1 ) );
+
+		/* Bass boost cause allpass attenuation */
+		_mm_storeu_pd( out, _mm_mul_pd( y, gain ) );
+
+		in  += 2;
+		out += 2;
+	} /* while */
+
+	_mm_storeu_pd( bs2bdp->lfs.asis, asis );
+	_mm_storeu_pd( bs2bdp->lfs.lo, lo );
+	_mm_storeu_pd( bs2bdp->lfs.hi, hi );
+} /* cross_feed_d() */
+
+/* Look-ahead by two stereo samples: the second one is computed from
+ * the state before the first one,
+ *   lo[ 1 ] = a0 * x[ 1 ] + a0 * b1 * x[ 0 ] + b1^2 * lo[ -1 ]
+ *   hi[ 1 ] = a0 * x[ 1 ] + ( a0 * b1 + a1 ) * x[ 0 ] + a1 * b1 * x[ -1 ]
+ *           + b1^2 * hi[ -1 ]
+ * so the recurrence is one multiply and add per two stereo samples.
+ * The first stereo sample of a pair is bit-exact with cross_feed_d().
+ */
+static SSE2 void cross_feed_ahead_d( t_bs2bdp bs2bdp,
+	double const *in, double *out, int n )
+{
+	__m128d a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain;
+	__m128d k1_lo, p2_lo, k1_hi, s1_hi, p2_hi;
+	__m128d asis, lo, hi, x0, x1, lo0, hi0, y;
+	int     m;
+
+	if( n <= 0 ) return;
+
+	a0_lo = _mm_set1_pd( bs2bdp->a0_lo );
+	b1_lo = _mm_set1_pd( bs2bdp->b1_lo );
+	a0_hi = _mm_set1_pd( bs2bdp->a0_hi );
+	a1_hi = _mm_set1_pd( bs2bdp->a1_hi );
+	b1_hi = _mm_set1_pd( bs2bdp->b1_hi );
+	gain  = _mm_set1_pd( bs2bdp->gain );
+
+	k1_lo = _mm_set1_pd( bs2bdp->a0_lo * bs2bdp->b1_lo );
+	p2_lo = _mm_set1_pd( bs2bdp->b1_lo * bs2bdp->b1_lo );
+	k1_hi = _mm_set1_pd( bs2bdp->a0_hi * bs2bdp->b1_hi + bs2bdp->a1_hi );
+	s1_hi = _mm_set1_pd( bs2bdp->a1_hi * bs2bdp->b1_hi );
+	p2_hi = _mm_set1_pd( bs2bdp->b1_hi * bs2bdp->b1_hi );
+
+	asis = _mm_loadu_pd( bs2bdp->lfs.asis );
+	lo   = _mm_loadu_pd( bs2bdp->lfs.lo );
+	hi   = _mm_loadu_pd( bs2bdp->lfs.hi );
+
+	for( m = n >> 1; m > 0; m-- )
+	{
+		x0 = _mm_loadu_pd( in );
+		x1 = _mm_loadu_pd( in + 2 );
+
+		/* Lowpass filter */
+		lo0 = _mm_add_pd( _mm_mul_pd( a0_lo, x0 ), _mm_mul_pd( b1_lo, lo ) );
+		lo  = _mm_add_pd(
+			_mm_add_pd( _mm_mul_pd( a0_lo, x1 ), _mm_mul_pd( k1_lo, x0 ) ),
+			_mm_mul_pd( p2_lo, lo ) );
+
+		/* Highboost filter */
+		hi0 = _mm_add_pd(
+			_mm_add_pd( _mm_mul_pd( a0_hi, x0 ), _mm_mul_pd( a1_hi, asis ) ),
+			_mm_mul_pd( b1_hi, hi ) );
+		hi  = _mm_add_pd(
+			_mm_add_pd(
+				_mm_add_pd( _mm_mul_pd( a0_hi, x1 ), _mm_mul_pd( k1_hi, x0 ) ),
+				_mm_mul_pd( s1_hi, asis ) ),
+			_mm_mul_pd( p2_hi, hi ) );
+		asis = x1;
+
+		/* Crossfeed, lowpassed channels are swapped */
+		y = _mm_add_pd( hi0, _mm_shuffle_pd( lo0, lo0, 1 ) );
+		_mm_storeu_pd( out, _mm_mul_pd( y, gain ) );
+		y = _mm_add_pd( hi, _mm_shuffle_pd( lo, lo, 1 ) );
+		_mm_storeu_pd( out + 2, _mm_mul_pd( y, gain ) );
+
+		in  += 4;
+		out += 4;
+	} /* for */
+
+	_mm_storeu_pd( bs2bdp->lfs.asis, asis );
+	_mm_storeu_pd( bs2bdp->lfs.lo, lo );
+	_mm_storeu_pd( bs2bdp->lfs.hi, hi );
+
+	/* An odd stereo sample */
+	cross_feed_d( bs2bdp, in, out, n & 1 );
+} /* cross_feed_ahead_d() */
+
+/* Single precision lowpass and highboost states share one register:
+ * lanes 0, 1 are lowpass states, lanes 2, 3 are highboost states
+ * of the first and second channel.
+ * The result is bit-exact with the scalar cross_feed_f().
+ */
+static SSE2 void cross_feed_f( t_bs2bdp bs2bdp,
+	float const *in, float *out, int n )
+{
+	__m128 a0, a1, b1, gain, asis, lfs, x, y;
+
+	if( n <= 0 ) return;
+
+	a0 = _mm_setr_ps(
+		bs2bdp->f.a0_lo, bs2bdp->f.a0_lo, bs2bdp->f.a0_hi, bs2bdp->f.a0_hi );
+	a1 = _mm_setr_ps( 0.0f, 0.0f, bs2bdp->f.a1_hi, bs2bdp->f.a1_hi );
+	b1 = _mm_setr_ps(
+		bs2bdp->f.b1_lo, bs2bdp->f.b1_lo, bs2bdp->f.b1_hi, bs2bdp->f.b1_hi );
+	gain = _mm_set1_ps( bs2bdp->f.gain );
+
+	asis = _mm_setr_ps( bs2bdp->lfsf.asis[ 0 ], bs2bdp->lfsf.asis[ 1 ],
+		bs2bdp->lfsf.asis[ 0 ], bs2bdp->lfsf.asis[ 1 ] );
+	lfs  = _mm_setr_ps( bs2bdp->lfsf.lo[ 0 ], bs2bdp->lfsf.lo[ 1 ],
+		bs2bdp->lfsf.hi[ 0 ], bs2bdp->lfsf.hi[ 1 ] );
+
+	while( n-- )
+	{
+		x = _mm_castpd_ps( _mm_load1_pd( ( double const * )in ) );
+
+		/* Lowpass and highboost filters */
+		lfs = _mm_add_ps(
+			_mm_add_ps( _mm_mul_ps( a0, x ), _mm_mul_ps( a1, asis ) ),
+			_mm_mul_ps( b1, lfs ) );
+		asis = x;
+
+		/* Crossfeed, lowpassed channels are swapped */
+		y = _mm_add_ps( _mm_movehl_ps( lfs, lfs ),
+			_mm_shuffle_ps( lfs, lfs, _MM_SHUFFLE( 3, 2, 0, 1 ) ) );
+
+		/* Bass boost cause allpass attenuation */
+		_mm_storel_pi( ( __m64 * )out, _mm_mul_ps( y, gain ) );
+
+		in  += 2;
+		out += 2;
+	} /* while */
+
+	_mm_storel_pi( ( __m64 * )bs2bdp->lfsf.asis, asis );
+	_mm_storel_pi( ( __m64 * )bs2bdp->lfsf.lo, lfs );
+	_mm_storeh_pi( ( __m64 * )bs2bdp->lfsf.hi, lfs );
+} /* cross_feed_f() */
+
+/* One stereo sample of four streams in 'x0', 'x1' through the filters */
+#define BATCH_STEP( x0, x1 ) \
+	lo0 = _mm_add_ps( _mm_mul_ps( a0_lo, x0 ), _mm_mul_ps( b1_lo, lo0 ) ); \
+	lo1 = _mm_add_ps( _mm_mul_ps( a0_lo, x1 ), _mm_mul_ps( b1_lo, lo1 ) ); \
+	hi0 = _mm_add_ps( \
+		_mm_add_ps( _mm_mul_ps( a0_hi, x0 ), _mm_mul_ps( a1_hi, asis0 ) ), \
+		_mm_mul_ps( b1_hi, hi0 ) ); \
+	hi1 = _mm_add_ps( \
+		_mm_add_ps( _mm_mul_ps( a0_hi, x1 ), _mm_mul_ps( a1_hi, asis1 ) ), \
+		_mm_mul_ps( b1_hi, hi1 ) ); \
+	asis0 = x0; \
+	asis1 = x1; \
+	x0 = _mm_mul_ps( _mm_add_ps( hi0, lo1 ), gain ); \
+	x1 = _mm_mul_ps( _mm_add_ps( hi1, lo0 ), gain )
+
+/* Streams of a batch in lanes, four at a time.
+ * The result is bit-exact with the scalar cross_feed_f().
+ */
+static SSE2 void cross_feed_batch_f( t_bs2b_batchp batch, size_t first,
+	float * const *sample, int n )
+{
+	__m128 a0_lo, b1_lo, a0_hi, a1_hi, b1_hi, gain;
+	__m128 asis0, asis1, lo0, lo1, hi0, hi1, x0, x1;
+	__m128 t0, t1, t2, t3;
+	float  l[ 4 ], r[ 4 ];
+	size_t k;
+	int    i, j;
+
+	for( k = 0; k < BS2B_BATCH_LANES; k += 4 )
+	{
+		a0_lo = _mm_loadu_ps( batch->a0_lo + first + k );
+		b1_lo = _mm_loadu_ps( batch->b1_lo + first + k );
+		a0_hi = _mm_loadu_ps( batch->a0_hi + first + k );
+		a1_hi = _mm_loadu_ps( batch->a1_hi + first + k );
+		b1_hi = _mm_loadu_ps( batch->b1_hi + first + k );
+		gain  = _mm_loadu_ps( batch->gain + first + k );
+
+		asis0 = _mm_loadu_ps( batch->asis[ 0 ] + first + k );
+		asis1 = _mm_loadu_ps( batch->asis[ 1 ] + first + k );
+		lo0   = _mm_loadu_ps( batch->lo[ 0 ] + first + k );
+		lo1   = _mm_loadu_ps( batch->lo[ 1 ] + first + k );
+		hi0   = _mm_loadu_ps( batch->hi[ 0 ] + first + k );
+		hi1   = _mm_loadu_ps( batch->hi[ 1 ] + first + k );
+
+		/* Two stereo samples of four streams are transposed to lanes */
+		for( i = 0; i + 2 <= n; i += 2 )
+		{
+			t0 = _mm_loadu_ps( sample[ k ] + i * 2 );
+			t1 = _mm_loadu_ps( sample[ k + 1 ] + i * 2 );
+			t2 = _mm_loadu_ps( sample[ k + 2 ] + i * 2 );
+			t3 = _mm_loadu_ps( sample[ k + 3 ] + i * 2 );
+			_MM_TRANSPOSE4_PS( t0, t1, t2, t3 );
+
+			BATCH_STEP( t0, t1 );
+			BATCH_STEP( t2, t3 );
+
+			_MM_TRANSPOSE4_PS( t0, t1, t2, t3 );
+			_mm_storeu_ps( sample[ k ] + i * 2, t0 );
+			_mm_storeu_ps( sample[ k + 1 ] + i * 2, t1 );
+			_mm_storeu_ps( sample[ k + 2 ] + i * 2, t2 );
+			_mm_storeu_ps( sample[ k + 3 ] + i * 2, t3 );
+		} /* for */
+
+		/* Rest of stereo samples one by one */
+		for( ; i < n; i++ )
+		{
+			for( j = 0; j < 4; j++ )
+			{
+				l[ j ] = sample[ k + j ][ i * 2 ];
+				r[ j ] = sample[ k + j ][ i * 2 + 1 ];
+			}
+
+			x0 = _mm_loadu_ps( l );
+			x1 = _mm_loadu_ps( r );
+			BATCH_STEP( x0, x1 );
+			_mm_storeu_ps( l, x0 );
+			_mm_storeu_ps( r, x1 );
+
+			for( j = 0; j < 4; j++ )
+			{
+				sample[ k + j ][ i * 2 ]     = l[ j ];
+				sample[ k + j ][ i * 2 + 1 ] = r[ j ];
+			}
+		} /* for */
+
+		_mm_storeu_ps( batch->asis[ 0 ] + first + k, asis0 );
+		_mm_storeu_ps( batch->asis[ 1 ] + first + k, asis1 );
+		_mm_storeu_ps( batch->lo[ 0 ] + first + k, lo0 );
+		_mm_storeu_ps( batch->lo[ 1 ] + first + k, lo1 );
+		_mm_storeu_ps( batch->hi[ 0 ] + first + k, hi0 );
+		_mm_storeu_ps( batch->hi[ 1 ] + first + k, hi1 );
+	} /* for */
+} /* cross_feed_batch_f() */
+
+static SSE2 void decode_f( void const *in, double *out, int n )
+{
+	float const *x = ( float const * )in;
+	__m128 v;
+
+	for( ; n >= 4; n -= 4, x += 4, out += 4 )
+	{
+		v = _mm_loadu_ps( x );
+		_mm_storeu_pd( out, _mm_cvtps_pd( v ) );
+		_mm_storeu_pd( out + 2, _mm_cvtps_pd( _mm_movehl_ps( v, v ) ) );
+	}
+
+	while( n-- )
+		*out++ = ( double )*x++;
+} /* decode_f() */
+
+static SSE2 void encode_f( double const *in, void *out, int n )
+{
+	float *y = ( float * )out;
+
+	for( ; n >= 4; n -= 4, in += 4, y += 4 )
+	{
+		_mm_storeu_ps( y, _mm_movelh_ps(
+			_mm_cvtpd_ps( _mm_loadu_pd( in ) ),
+			_mm_cvtpd_ps( _mm_loadu_pd( in + 2 ) ) ) );
+	}
+
+	while( n-- )
+		*y++ = ( float )*in++;
+} /* encode_f() */
+
+/* Planar channels */
+
+static SSE2 void zip_d( double const *left, double const *right,
+	double *out, int n )
+{
+	__m128d l, r;
+
+	for( ; n >= 2; n -= 2, left += 2, right += 2, out += 4 )
+	{
+		l = _mm_loadu_pd( left );
+		r = _mm_loadu_pd( right );
+		_mm_storeu_pd( out, _mm_unpacklo_pd( l, r ) );
+		_mm_storeu_pd( out + 2, _mm_unpackhi_pd( l, r ) );
+	}
+
+	if( n > 0 )
+	{
+		out[ 0 ] = *left;
+		out[ 1 ] = *right;
+	}
+} /* zip_d() */
+
+static SSE2 void zip_f( float const *left, float const *right,
+	float *out, int n )
+{
+	__m128 l, r;
+
+	for( ; n >= 4; n -= 4, left += 4, right += 4, out += 8 )
+	{
+		l = _mm_loadu_ps( left );
+		r = _mm_loadu_ps( right );
+		_mm_storeu_ps( out, _mm_unpacklo_ps( l, r ) );
+		_mm_storeu_ps( out + 4, _mm_unpackhi_ps( l, r ) );
+	}
+
+	while( n-- )
+	{
+		*out++ = *left++;
+		*out++ = *right++;
+	}
+} /* zip_f() */
+
+static SSE2 void unzip_d( double const *in, double *left, double *right,
+	int n )
+{
+	__m128d a, b;
+
+	for( ; n >= 2; n -= 2, in += 4, left += 2, right += 2 )
+	{
+		a = _mm_loadu_pd( in );
+		b = _mm_loadu_pd( in + 2 );
+		_mm_storeu_pd( left, _mm_unpacklo_pd( a, b ) );
+		_mm_storeu_pd( right, _mm_unpackhi_pd( a, b ) );
+	}
+
+	if( n > 0 )
+	{
+		*left  = in[ 0 ];
+		*right = in[ 1 ];
+	}
+} /* unzip_d() */
+
+static SSE2 void unzip_f( float const *in, float *left, float *right, int n )
+{
+	__m128 a, b;
+
+	for( ; n >= 4; n -= 4, in += 8, left += 4, right += 4 )
+	{
+		a = _mm_loadu_ps( in );
+		b = _mm_loadu_ps( in + 4 );
+		_mm_storeu_ps( left,
+			_mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+		_mm_storeu_ps( right,
+			_mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+	}
+
+	while( n-- )
+	{
+		*left++  = *in++;
+		*right++ = *in++;
+	}
+} /* unzip_f() */
+
+/* Flush-to-zero and denormals-are-zero bits of MXCSR */
+#define MXCSR_FTZ_DAZ 0x8040
+
+static SSE2 unsigned int flush_fpu( void )
+{
+	unsigned int mode = _mm_getcsr();
+
+	_mm_setcsr( mode | MXCSR_FTZ_DAZ );
+
+	return mode;
+} /* flush_fpu() */
+
+static SSE2 void restore_fpu( unsigned int mode )
+{
+	_mm_setcsr( mode );
+} /* restore_fpu() */
+
+static SSE2 int is_zero( void const *in, int n )
+{
+	unsigned char const *x = ( unsigned char const * )in;
+	unsigned char       tail = 0;
+	__m128i             acc = _mm_setzero_si128();
+
+	for( ; n >= 16; n -= 16, x += 16 )
+		acc = _mm_or_si128( acc, _mm_loadu_si128( ( __m128i const * )x ) );
+
+	while( n-- )
+		tail |= *x++;
+
+	acc = _mm_cmpeq_epi8( acc, _mm_setzero_si128() );
+
+	return 0 == tail && 0xffff == _mm_movemask_epi8( acc );
+} /* is_zero() */
+
+/* Byte swaps of 16, 32 and 64 bit lanes */
+static SSE2 __m128i bswap16( __m128i v )
+{
+	return _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) );
+} /* bswap16() */
+
+static SSE2 __m128i bswap32( __m128i v )
+{
+	v = bswap16( v );
+	return _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, 0xb1 ), 0xb1 );
+} /* bswap32() */
+
+static SSE2 __m128i bswap64( __m128i v )
+{
+	v = bswap16( v );
+	return _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, 0x1b ), 0x1b );
+} /* bswap64() */
+
+/* Byte swapped doubles and floats */
+
+static SSE2 void decode_dx( void const *in, double *out, int n )
+{
+	double const *x = ( double const * )in;
+
+	for( ; n >= 2; n -= 2, x += 2, out += 2 )
+		_mm_storeu_pd( out, _mm_castsi128_pd(
+			bswap64( _mm_loadu_si128( ( __m128i const * )x ) ) ) );
+
+	if( n > 0 )
+		_mm_storel_pd( out, _mm_castsi128_pd(
+			bswap64( _mm_loadl_epi64( ( __m128i const * )x ) ) ) );
+} /* decode_dx() */
+
+static SSE2 void encode_dx( double const *in, void *out, int n )
+{
+	double *y = ( double * )out;
+
+	for( ; n >= 2; n -= 2, in += 2, y += 2 )
+		_mm_storeu_si128( ( __m128i * )y,
+			bswap64( _mm_castpd_si128( _mm_loadu_pd( in ) ) ) );
+
+	if( n > 0 )
+		_mm_storel_epi64( ( __m128i * )y,
+			bswap64( _mm_castpd_si128( _mm_load_sd( in ) ) ) );
+} /* encode_dx() */
+
+static SSE2 void swap32( void const *in, void *out, int n )
+{
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t *y = ( uint32_t * )out;
+
+	for( ; n >= 4; n -= 4, x += 4, y += 4 )
+		_mm_storeu_si128( ( __m128i * )y,
+			bswap32( _mm_loadu_si128( ( __m128i const * )x ) ) );
+
+	while( n-- )
+	{
+		*y++ = BS2B_SWAP32( *x );
+		x++;
+	}
+} /* swap32() */
+
+static SSE2 void decode_fx( void const *in, double *out, int n )
+{
+	uint32_t const *x = ( uint32_t const * )in;
+	uint32_t y[ 4 ];
+	__m128 v;
+
+	for( ; n >= 4; n -= 4, x += 4, out += 4 )
+	{
+		v = _mm_castsi128_ps(
+			bswap32( _mm_loadu_si128( ( __m128i const * )x ) ) );
+		_mm_storeu_pd( out, _mm_cvtps_pd( v ) );
+		_mm_storeu_pd( out + 2, _mm_cvtps_pd( _mm_movehl_ps( v, v ) ) );
+	}
+
+	if( n > 0 )
+	{
+		swap32( x, y, n );
+		decode_f( y, out, n );
+	}
+} /* decode_fx() */
+
+static SSE2 void encode_fx( double const *in, void *out, int n )
+{
+	uint32_t *y = ( uint32_t * )out;
+	uint32_t x[ 4 ];
+
+	for( ; n >= 4; n -= 4, in += 4, y += 4 )
+	{
+		_mm_storeu_si128( ( __m128i * )y, bswap32( _mm_castps_si128(
+			_mm_movelh_ps(
+			_mm_cvtpd_ps( _mm_loadu_pd( in ) ),
+			_mm_cvtpd_ps( _mm_loadu_pd( in + 2 ) ) ) ) ) );
+	}
+
+	if( n > 0 )
+	{
+		encode_f( in, x, n );
+		swap32( x, y, n );
+	}
+} /* encode_fx() */
+
+/* Integer codecs. Unsigned formats are biased to signed ones by XOR.
+ * 8 and 16 bit samples are clipped by saturating packs: a crossfeed
+ * of these formats never gets out of 32 bit integer range.
+ */
+
+#define MAX_INT32_VALUE  2147483647.0
+#define MIN_INT32_VALUE -2147483648.0
+
+/* Truncates 4 doubles to 32 bit integers */
+static SSE2 __m128i cvtt4( double const *in )
+{
+	return _mm_unpacklo_epi64(
+		_mm_cvttpd_epi32( _mm_loadu_pd( in ) ),
+		_mm_cvttpd_epi32( _mm_loadu_pd( in + 2 ) ) );
+} /* cvtt4() */
+
+/* Converts 4 32 bit integers to doubles */
+static SSE2 void cvt4( __m128i v, double *out )
+{
+	_mm_storeu_pd( out, _mm_cvtepi32_pd( v ) );
+	_mm_storeu_pd( out + 2, _mm_cvtepi32_pd( _mm_unpackhi_epi64( v, v ) ) );
+} /* cvt4() */
+
+static SSE2 void decode_32( void const *in, double *out, int n,
+	uint32_t bias, int swap )
+{
+	uint32_t const *x = ( uint32_t const * )in;
+	__m128i b = _mm_set1_epi32( ( int )bias ), v;
+	uint32_t y;
+
+	for( ; n >= 4; n -= 4, x += 4, out += 4 )
+	{
+		v = _mm_loadu_si128( ( __m128i const * )x );
+		if( swap ) v = bswap32( v );
+		cvt4( _mm_xor_si128( v, b ), out );
+	}
+
+	while( n-- )
+	{
+		y = *x++;
+		if( swap ) y = BS2B_SWAP32( y );
+		*out++ = ( double )( int32_t )( y ^ bias );
+	}
+} /* decode_32() */
+
+static SSE2 void encode_32( double const *in, void *out, int n,
+	uint32_t bias, int swap )
+{
+	uint32_t *y = ( uint32_t * )out;
+	__m128i b = _mm_set1_epi32( ( int )bias ), v;
+	__m128d max = _mm_set1_pd( MAX_INT32_VALUE );
+	__m128d min = _mm_set1_pd( MIN_INT32_VALUE );
+	double  x;
+
+	for( ; n >= 4; n -= 4, in += 4, y += 4 )
+	{
+		v = _mm_xor_si128( _mm_unpacklo_epi64(
+			_mm_cvttpd_epi32(
+				_mm_min_pd( _mm_max_pd( _mm_loadu_pd( in ), min ), max ) ),
+			_mm_cvttpd_epi32(
+				_mm_min_pd( _mm_max_pd( _mm_loadu_pd( in + 2 ), min ), max ) ) ),
+			b );
+		if( swap ) v = bswap32( v );
+		_mm_storeu_si128( ( __m128i * )y, v );
+	}
+
+	while( n-- )
+	{
+		x = *in++;
+
+		/* Clipping of overloaded samples */
+		if( x > MAX_INT32_VALUE ) x = MAX_INT32_VALUE;
+		if( x < MIN_INT32_VALUE ) x = MIN_INT32_VALUE;
+
+		*y = ( uint32_t )( int32_t )x ^ bias;
+		if( swap ) *y = BS2B_SWAP32( *y );
+		y++;
+	}
+} /* encode_32() */
+
+static SSE2 void decode_16( void const *in, double *out, int n,
+	uint16_t bias, int swap )
+{
+	uint16_t const *x = ( uint16_t const * )in;
+	__m128i b = _mm_set1_epi16( ( short )bias ), v;
+	uint16_t y;
+
+	for( ; n >= 8; n -= 8, x += 8, out += 8 )
+	{
+		v = _mm_loadu_si128( ( __m128i const * )x );
+		if( swap ) v = bswap16( v );
+		v = _mm_xor_si128( v, b );
+		cvt4( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ), out );
+		cvt4( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ), out + 4 );
+	}
+
+	while( n-- )
+	{
+		y = *x++;
+		if( swap ) y = BS2B_SWAP16( y );
+		*out++ = ( double )( int16_t )( y ^ bias );
+	}
+} /* decode_16() */
+
+static SSE2 void encode_16( double const *in, void *out, int n,
+	uint16_t bias, int swap )
+{
+	uint16_t *y = ( uint16_t * )out;
+	__m128i b = _mm_set1_epi16( ( short )bias ), v;
+	double  x;
+
+	for( ; n >= 8; n -= 8, in += 8, y += 8 )
+	{
+		v = _mm_xor_si128( _mm_packs_epi32( cvtt4( in ), cvtt4( in + 4 ) ), b );
+		if( swap ) v = bswap16( v );
+		_mm_storeu_si128( ( __m128i * )y, v );
+	}
+
+	while( n-- )
+	{
+		x = *in++;
+
+		/* Clipping of overloaded samples */
+		if( x > 32767.0 ) x = 32767.0;
+		if( x < -32768.0 ) x = -32768.0;
+
+		*y = ( uint16_t )( ( int16_t )x ^ bias );
+		if( swap ) *y = BS2B_SWAP16( *y );
+		y++;
+	}
+} /* encode_16() */
+
+static SSE2 void decode_8( void const *in, double *out, int n, uint8_t bias )
+{
+	uint8_t const *x = ( uint8_t const * )in;
+	__m128i b = _mm_set1_epi8( ( char )bias ), v;
+
+	for( ; n >= 8; n -= 8, x += 8, out += 8 )
+	{
+		v = _mm_xor_si128( _mm_loadl_epi64( ( __m128i const * )x ), b );
+		v = _mm_srai_epi16( _mm_unpacklo_epi8( v, v ), 8 );
+		cvt4( _mm_srai_epi32( _mm_unpacklo_epi16( v, v ), 16 ), out );
+		cvt4( _mm_srai_epi32( _mm_unpackhi_epi16( v, v ), 16 ), out + 4 );
+	}
+
+	while( n-- )
+		*out++ = ( double )( int8_t )( *x++ ^ bias );
+} /* decode_8() */
+
+static SSE2 void encode_8( double const *in, void *out, int n, uint8_t bias )
+{
+	uint8_t *y = ( uint8_t * )out;
+	__m128i b = _mm_set1_epi8( ( char )bias ), v;
+	double  x;
+
+	for( ; n >= 8; n -= 8, in += 8, y += 8 )
+	{
+		v = _mm_packs_epi32( cvtt4( in ), cvtt4( in + 4 ) );
+		_mm_storel_epi64( ( __m128i * )y,
+			_mm_xor_si128( _mm_packs_epi16( v, v ), b ) );
+	}
+
+	while( n-- )
+	{
+		x = *in++;
+
+		/* Clipping of overloaded samples */
+		if( x > 127.0 ) x = 127.0;
+		if( x < -128.0 ) x = -128.0;
+
+		*y++ = ( uint8_t )( ( int8_t )x ^ bias );
+	}
+} /* encode_8() */
+
+static SSE2 void decode_s32( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0, 0 );
+} /* decode_s32() */
+
+static SSE2 void encode_s32( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0, 0 );
+} /* encode_s32() */
+
+static SSE2 void decode_s32x( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0, 1 );
+} /* decode_s32x() */
+
+static SSE2 void encode_s32x( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0, 1 );
+} /* encode_s32x() */
+
+static SSE2 void decode_u32( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0x80000000, 0 );
+} /* decode_u32() */
+
+static SSE2 void encode_u32( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0x80000000, 0 );
+} /* encode_u32() */
+
+static SSE2 void decode_u32x( void const *in, double *out, int n )
+{
+	decode_32( in, out, n, 0x80000000, 1 );
+} /* decode_u32x() */
+
+static SSE2 void encode_u32x( double const *in, void *out, int n )
+{
+	encode_32( in, out, n, 0x80000000, 1 );
+} /* encode_u32x() */
+
+static SSE2 void decode_s16( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0, 0 );
+} /* decode_s16() */
+
+static SSE2 void encode_s16( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0, 0 );
+} /* encode_s16() */
+
+static SSE2 void decode_s16x( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0, 1 );
+} /* decode_s16x() */
+
+static SSE2 void encode_s16x( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0, 1 );
+} /* encode_s16x() */
+
+static SSE2 void decode_u16( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0x8000, 0 );
+} /* decode_u16() */
+
+static SSE2 void encode_u16( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0x8000, 0 );
+} /* encode_u16() */
+
+static SSE2 void decode_u16x( void const *in, double *out, int n )
+{
+	decode_16( in, out, n, 0x8000, 1 );
+} /* decode_u16x() */
+
+static SSE2 void encode_u16x( double const *in, void *out, int n )
+{
+	encode_16( in, out, n, 0x8000, 1 );
+} /* encode_u16x() */
+
+static SSE2 void decode_s8( void const *in, double *out, int n )
+{
+	decode_8( in, out, n, 0 );
+} /* decode_s8() */
+
+static SSE2 void encode_s8( double const *in, void *out, int n )
+{
+	encode_8( in, out, n, 0 );
+} /* encode_s8() */
+
+static SSE2 void decode_u8( void const *in, double *out, int n )
+{
+	decode_8( in, out, n, 0x80 );
+} /* decode_u8() */
+
+static SSE2 void encode_u8( double const *in, void *out, int n )
+{
+	encode_8( in, out, n, 0x80 );
+} /* encode_u8() */
+
+t_bs2b_kernel const bs2b_kernel_sse2 =
+{
+	BS2B_KERNEL_SSE2, "sse2",
+	cross_feed_d,
+	cross_feed_ahead_d,
+	cross_feed_f,
+	NULL,       /* No signed 32 x 32 bit multiply in SSE2 */
+	NULL,
+	swap32,
+	zip_d,   zip_f,
+	unzip_d, unzip_f,
+	flush_fpu, restore_fpu,
+	is_zero,
+	cross_feed_batch_f,
+	{
+		decode_dx,
+		decode_f,   decode_fx,
+		decode_s32, decode_s32x, decode_u32, decode_u32x,
+		decode_s16, decode_s16x, decode_u16, decode_u16x,
+		decode_s8,  decode_u8
+	},
+	{
+		encode_dx,
+		encode_f,   encode_fx,
+		encode_s32, encode_s32x, encode_u32, encode_u32x,
+		encode_s16, encode_s16x, encode_u16, encode_u16x,
+		encode_s8,  encode_u8
+	}
+};
+
+#endif /* BS2B_HAVE_X86 */
@@ -0,0 +1,119 @@
+/*-
+ * Copyright (c) 2005 Boris Mikhaylov
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Minimal threading primitives of the library. Not installed. */
+
+#ifndef BS2BTHREAD_H
+#define BS2BTHREAD_H
+
+#ifdef _WIN32
+
+#include <windows.h>
+
+/* A spin lock, critical sections are a few dozens of instructions */
+typedef volatile LONG bs2b_mutex;
+
+#define BS2B_MUTEX_INIT 0
+
+#define bs2b_mutex_lock( m ) \
+	while( InterlockedExchange( ( m ), 1 ) ) Sleep( 0 )
+#define bs2b_mutex_unlock( m ) InterlockedExchange( ( m ), 0 )
+#define bs2b_mutex_init( m )   ( *( m ) = 0 )
+#define bs2b_mutex_destroy( m ) ( ( void )( m ) )
+
+/* Sequentially consistent on Windows */
+typedef volatile LONG bs2b_atomic;
+
+#define bs2b_atomic_load( a ) InterlockedCompareExchange( ( a ), 0, 0 )
+#define bs2b_atomic_store( a, v ) InterlockedExchange( ( a ), ( v ) )
+#define bs2b_atomic_exchange( a, v ) InterlockedExchange( ( a ), ( v ) )
+
+/* Worker threads, return 0 on success */
+typedef HANDLE bs2b_thread;
+
+typedef LPTHREAD_START_ROUTINE bs2b_thread_proc;
+
+#define BS2B_THREAD_PROC( name, arg ) DWORD WINAPI name( LPVOID arg )
+#define BS2B_THREAD_RETURN 0
+
+#define bs2b_thread_create( t, proc, arg ) \
+	( NULL == ( *( t ) = CreateThread( NULL, 0, ( proc ), ( arg ), 0, NULL ) ) )
+#define bs2b_thread_join( t ) \
+	( WaitForSingleObject( ( t ), INFINITE ), CloseHandle( t ) )
+
+/* Processor groups of more than 64 CPUs are counted since Windows 7,
+ * older SDKs and targets only see the group of the calling thread
+ */
+#if defined( _WIN32_WINNT ) && _WIN32_WINNT >= 0x0601
+#define bs2b_cpu_count() \
+	( ( int )GetActiveProcessorCount( ALL_PROCESSOR_GROUPS ) )
+#else
+static int bs2b_cpu_count( void )
+{
+	SYSTEM_INFO si;
+
+	GetSystemInfo( &si );
+	return ( int )si.dwNumberOfProcessors;
+} /* bs2b_cpu_count() */
+#endif /* _WIN32_WINNT */
+
+#else /* !_WIN32 */
+
+#include <pthread.h>
+#include <unistd.h>
+
+typedef pthread_mutex_t bs2b_mutex;
+
+#define BS2B_MUTEX_INIT PTHREAD_MUTEX_INITIALIZER
+
+#define bs2b_mutex_lock( m )   pthread_mutex_lock( m )
+#define bs2b_mutex_unlock( m ) pthread_mutex_unlock( m )
+#define bs2b_mutex_init( m )   pthread_mutex_init( ( m ), NULL )
+#define bs2b_mutex_destroy( m ) pthread_mutex_destroy( m )
+
+/* Loads acquire, stores release */
+typedef int bs2b_atomic;
+
+#define bs2b_atomic_load( a ) __atomic_load_n( ( a ), __ATOMIC_ACQUIRE )
+#define bs2b_atomic_store( a, v ) \
+	__atomic_store_n( ( a ), ( v ), __ATOMIC_RELEASE )
+#define bs2b_atomic_exchange( a, v ) \
+	__atomic_exchange_n( ( a ), ( v ), __ATOMIC_ACQ_REL )
+
+/* Worker threads, return 0 on success */
+typedef pthread_t bs2b_thread;
+
+typedef void *( *bs2b_thread_proc )( void *arg );
+
+#define BS2B_THREAD_PROC( name, arg ) void *name( void *arg )
+#define BS2B_THREAD_RETURN NULL
+
+#define bs2b_thread_create( t, proc, arg ) \
+	pthread_create( ( t ), NULL, ( proc ), ( arg ) )
+#define bs2b_thread_join( t ) pthread_join( ( t ), NULL )
+
+#define bs2b_cpu_count() ( ( int )sysconf( _SC_NPROCESSORS_ONLN ) )
+
+#endif /* _WIN32 */
+
+#endif	/* BS2BTHREAD_H */